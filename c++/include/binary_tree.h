@@ -10,118 +10,951 @@
 #pragma once
 
 #include <algorithm> // find_if
-#include <memory>    // std::unique_ptr
+#include <functional> // std::less
+#include <memory>    // std::allocator_traits
+#include <stdexcept> // std::out_of_range
+#include <tuple>     // std::forward_as_tuple
 #include <iomanip>   // cout alignment
 #include <iostream>  // std::cout, endl
 #include <math.h>    // pow()
 #include <vector>    // for tree balancing
 #include <utility>   // pair
+#include <initializer_list>
+#include <iterator>  // iterator_traits
+#include <type_traits>
+
+#include "frozen_tree.h"
+#include "instrument.h"
+#include "key_prefix.h"
+#include "snapshot.h"
+#include "thread_pool.h"
 
 
 
 /*! namespace for things not directly able to interact with Tree */
 namespace detail {
 
-    template <class K, class T>
-    struct Node {
+    /*! tree node; Meta is the per-node bookkeeping required by the balancing policy, Prefix the key traits
+        (see key_prefix.h): when enabled the node keeps the prefix of its key. Links come before the pair,
+        so that a descent reads them, the metadata and the prefix from the same cache line */
+    template <class K, class T, class Meta, class Prefix = key_prefix<K, void>>
+    struct Node : Meta, prefix_storage<Prefix::enabled> {
         using data_type = std::pair<const K, T>;
+        using meta_type = Meta;
 
-        data_type data;
-        /*! unique pointer to the left node */
-        std::unique_ptr<Node> left  = nullptr;
-        /*! unique pointer to the right node*/
-        std::unique_ptr<Node> right = nullptr;
+        /*! pointer to the left node, owned by the tree */
+        Node * left  = nullptr;
+        /*! pointer to the right node, owned by the tree */
+        Node * right = nullptr;
         Node * parent = nullptr;
+        data_type data;
 
 
         Node() = default;
-        /*! node constructor by declared value*/
-        Node(K k, T val)
-        : data(k, val)
-        {};
+        /*! node constructor from key and value, each copied or moved */
+        template <class Key, class Value>
+        Node(Key && k, Value && val)
+        : data(std::forward<Key>(k), std::forward<Value>(val))
+        { store_prefix(); };
+        /*! node constructor building key and value in place from the arguments in the two tuples */
+        template <class... KeyArgs, class... ValueArgs>
+        Node(std::piecewise_construct_t, std::tuple<KeyArgs...> k, std::tuple<ValueArgs...> val)
+        : data(std::piecewise_construct, std::move(k), std::move(val))
+        { store_prefix(); };
+        /*! node constructor from a key-value pair, copied or moved */
+        template <class Pair>
+        explicit Node(Pair && pair)
+        : data(std::forward<Pair>(pair))
+        { store_prefix(); };
+
+    private:
+        void store_prefix() noexcept {
+            if constexpr (Prefix::enabled) { this->prefix = Prefix::of(data.first); }
+        }
     };
 
-    /*!clone a node, including children pointers and parent*/
-    template <class K, class T>
-    std::unique_ptr<Node<K, T>> clone(const Node<K, T> * old) {
-        auto node = std::make_unique<Node<K, T>>(old->data.first, old->data.second);
-        if (old->left) {
-            node->left = clone(old->left.get());
-            node->left->parent = node.get();
-        };
-        if (old->right) {
-            node->right = clone(old->right.get());
-            node->right->parent = node.get();
-        };
-        return node;
-    }
-
     /*! helper function to traverse left nodes until there is any, giving the min(key) */
     template <typename NodeType>
     NodeType * allLeft(NodeType * node) noexcept {
-        while (node->left) { node = node->left.get(); }
+        while (node->left) { node = node->left; }
         return node;
     }
 
     /*! helper function to traverse right nodes until there is any, giving max(key)*/
     template <typename NodeType>
     NodeType * allRight(NodeType * node) noexcept {
-        while (node->right) { node = node->right.get(); }
+        while (node->right) { node = node->right; }
         return node;
     }
 
     /*! helper function to return next node*/
     template <typename NodeType>
     NodeType * successor(NodeType * node) noexcept {
-        if (node->right) { return allLeft(node->right.get()); }
+        if (node->right) { return allLeft(node->right); }
         auto * parent = node->parent;
-        while (parent && node == parent->right.get()) {
+        while (parent && node == parent->right) {
             node = parent;
             parent = node->parent;
         }
         return parent;
     }
 
+    /*! helper function to return previous node*/
     template <typename NodeType>
-    void attachLeft(NodeType * parent, std::unique_ptr<NodeType> child) {
+    NodeType * predecessor(NodeType * node) noexcept {
+        if (node->left) { return allRight(node->left); }
+        auto * parent = node->parent;
+        while (parent && node == parent->left) {
+            node = parent;
+            parent = node->parent;
+        }
+        return parent;
+    }
+
+    template <typename NodeType>
+    void attachLeft(NodeType * parent, NodeType * child) noexcept {
         if (child) { child->parent = parent; }
-        parent->left = std::move(child);
+        parent->left = child;
     }
 
     template <typename NodeType>
-    void attachRight(NodeType * parent, std::unique_ptr<NodeType> child) {
+    void attachRight(NodeType * parent, NodeType * child) noexcept {
         if (child) { child->parent = parent; }
-        parent->right = std::move(child);
+        parent->right = child;
+    }
+
+    /*! helper function returning the link pointing to node: a child pointer of its parent, or root */
+    template <typename NodeType>
+    NodeType *& ownerOf(NodeType * node, NodeType *& root) noexcept {
+        if (!node->parent) { return root; }
+        return node->parent->left == node ? node->parent->left : node->parent->right;
+    }
+
+    /*! left rotation: the right child of node takes its place. Returns the new subtree root */
+    template <typename NodeType>
+    NodeType * rotateLeft(NodeType * node, NodeType *& root) noexcept {
+        auto & owner = ownerOf(node, root);
+        auto * pivot = node->right;
+        attachRight(node, pivot->left);
+        pivot->parent = node->parent;
+        attachLeft(pivot, node);
+        owner = pivot;
+        return pivot;
     }
+
+    /*! right rotation: the left child of node takes its place. Returns the new subtree root */
+    template <typename NodeType>
+    NodeType * rotateRight(NodeType * node, NodeType *& root) noexcept {
+        auto & owner = ownerOf(node, root);
+        auto * pivot = node->left;
+        attachLeft(node, pivot->right);
+        pivot->parent = node->parent;
+        attachRight(pivot, node);
+        owner = pivot;
+        return pivot;
+    }
+
+    /*! number of levels below (and including) node. Walks the subtree through parent pointers, without recursion */
+    template <typename NodeType>
+    std::size_t measureHeight(const NodeType * node) noexcept {
+        if (!node) { return 0; }
+        const NodeType * const stop = node->parent;
+        const NodeType * previous = stop;
+        std::size_t depth = 1, height = 0;
+        while (node != stop) {
+            const NodeType * next;
+            if (previous == node->parent) {                         // first visit, coming from above
+                height = std::max(height, depth);
+                next = node->left ? node->left : node->right ? node->right : node->parent;
+            } else if (previous == node->left && node->right) { // back from the left subtree
+                next = node->right;
+            } else {                                                // both subtrees done
+                next = node->parent;
+            }
+            if (next == node->parent) { --depth; } else { ++depth; }
+            previous = node;
+            node = next;
+        }
+        return height;
+    }
+
+    /*! visits every node of a subtree after its children, walking through parent pointers without recursion.
+        visit must not unlink or free the node */
+    template <typename NodeType, class Visit>
+    void postOrder(NodeType * node, Visit && visit) {
+        if (!node) { return; }
+        NodeType * const stop = node->parent;
+        NodeType * previous = stop;
+        while (node != stop) {
+            NodeType * next;
+            if (previous == node->parent && node->left) {                       // first visit, go left
+                next = node->left;
+            } else if (previous != node->right && node->right) {                // left subtree done, go right
+                next = node->right;
+            } else {                                                            // both subtrees done
+                visit(node);
+                next = node->parent;
+            }
+            previous = node;
+            node = next;
+        }
+    }
+
+    /*! first phase of the Day-Stout-Warren algorithm: right rotations turn the tree in a "vine",
+        a sorted list linked through right pointers. Returns the number of nodes */
+    template <typename NodeType>
+    std::size_t treeToVine(NodeType *& root) noexcept {
+        std::size_t count = 0;
+        NodeType * parent = nullptr;
+        NodeType ** link = &root;
+        while (*link) {
+            NodeType * node = *link;
+            if (node->left) {               // rotate the left child up
+                NodeType * pivot = node->left;
+                attachLeft(node, pivot->right);
+                pivot->parent = parent;
+                attachRight(pivot, node);
+                *link = pivot;
+            } else {                        // node is in place, move down the vine
+                ++count;
+                parent = node;
+                link = &node->right;
+            }
+        }
+        return count;
+    }
+
+    /*! left rotations of every other node along the right spine, count times */
+    template <typename NodeType>
+    void compress(NodeType *& root, std::size_t count) noexcept {
+        NodeType * parent = nullptr;
+        NodeType ** link = &root;
+        for (std::size_t i = 0; i < count; ++i) {
+            NodeType * node = *link;
+            NodeType * pivot = node->right;
+            attachRight(node, pivot->left);
+            pivot->parent = parent;
+            attachLeft(pivot, node);
+            *link = pivot;
+            parent = pivot;
+            link = &pivot->right;
+        }
+    }
+
+    /*! second phase of the Day-Stout-Warren algorithm: folds a vine of count nodes into a complete tree,
+        whose leaves all lie on the last two levels */
+    template <typename NodeType>
+    void vineToTree(NodeType *& root, std::size_t count) noexcept {
+        std::size_t full = 0;                       // nodes of the largest perfect tree not bigger than count
+        while (2 * full + 1 <= count) { full = 2 * full + 1; }
+        compress(root, count - full);              // leaves of the incomplete last level
+        for (std::size_t size = full; size > 1; ) {
+            size /= 2;
+            compress(root, size);
+        }
+    }
+
+    /*! true if the allocator can free all its memory at once through release(), when sole_owner() tells
+        that no other allocator shares it */
+    template <class Alloc, class = void>
+    struct has_release : std::false_type {};
+
+    template <class Alloc>
+    struct has_release<Alloc, std::void_t<decltype(std::declval<Alloc &>().release()),
+                                          decltype(std::declval<const Alloc &>().sole_owner())>> : std::true_type {};
+
+    /*! true if the allocator can preallocate room for many objects through reserve(n) */
+    template <class Alloc, class = void>
+    struct has_reserve : std::false_type {};
+
+    template <class Alloc>
+    struct has_reserve<Alloc, std::void_t<decltype(std::declval<Alloc &>().reserve(std::size_t{}))>> : std::true_type {};
+}
+
+
+/*! balancing policies, selected with the fourth template parameter of Tree */
+namespace balancing {
+
+    /*! no extra per-node data */
+    struct no_augment {
+        struct node_data {};
+
+        template <typename NodeType>
+        static void update(NodeType *) noexcept {}
+    };
+
+    /*! number of nodes of the subtree rooted in each node: rank and select in O(height) */
+    struct subtree_size {
+        struct node_data { std::size_t size = 1; };
+
+        template <typename NodeType>
+        static std::size_t sizeOf(const NodeType * node) noexcept { return node ? node->size : 0; }
+
+        template <typename NodeType>
+        static void update(NodeType * node) noexcept {
+            node->size = 1 + sizeOf(node->left) + sizeOf(node->right);
+        }
+    };
+
+    /*! plain binary search tree: insert and erase never restructure it, balance() has to be called by hand.
+        Augment adds per-node data computed from the children, refreshed on the path back to root */
+    template <class Augment = no_augment>
+    struct basic_none {
+        /*! per-node bookkeeping: only the augmentation, if any */
+        struct node_data : Augment::node_data {};
+
+        /*! recomputes the bookkeeping of node from its children */
+        template <typename NodeType>
+        static void update(NodeType * node) noexcept { Augment::update(node); }
+
+        /*! restores the policy invariants on the path from node up to root, after an insert or erase below node */
+        template <typename NodeType>
+        static void rebalance(NodeType * node, NodeType *&) noexcept {
+            if constexpr (!std::is_empty<node_data>::value) {
+                for (; node; node = node->parent) { update(node); }
+            }
+        }
+
+        /*! tree height, O(n) since it is not tracked */
+        template <typename NodeType>
+        static std::size_t height(const NodeType * root) noexcept { return detail::measureHeight(root); }
+    };
+
+    /*! AVL tree: the heights of the two subtrees of every node differ at most by one,
+        so the tree height stays below 1.44 log2(N) whatever the insertion order */
+    template <class Augment = no_augment>
+    struct basic_avl {
+        /*! height of the subtree rooted in the node, and the augmentation, if any */
+        struct node_data : Augment::node_data { int height = 1; };
+
+        template <typename NodeType>
+        static int heightOf(const NodeType * node) noexcept { return node ? node->height : 0; }
+
+        template <typename NodeType>
+        static int skew(const NodeType * node) noexcept {
+            return heightOf(node->left) - heightOf(node->right);
+        }
+
+        template <typename NodeType>
+        static void update(NodeType * node) noexcept {
+            node->height = 1 + std::max(heightOf(node->left), heightOf(node->right));
+            Augment::update(node);
+        }
+
+        template <typename NodeType>
+        static void rebalance(NodeType * node, NodeType *& root) noexcept {
+            for (; node; node = node->parent) {
+                const int before = node->height;
+                update(node);
+                if (skew(node) > 1) {
+                    if (skew(node->left) < 0) {
+                        update(detail::rotateLeft(node->left, root)->left);
+                    }
+                    node = detail::rotateRight(node, root);
+                    update(node->right);
+                    update(node->left);
+                    update(node);
+                } else if (skew(node) < -1) {
+                    if (skew(node->right) > 0) {
+                        update(detail::rotateRight(node->right, root)->right);
+                    }
+                    node = detail::rotateLeft(node, root);
+                    update(node->left);
+                    update(node->right);
+                    update(node);
+                } else if (node->height == before && std::is_empty<typename Augment::node_data>::value) {
+                    return;     // same height and no rotation: nothing changes further up
+                }
+            }
+        }
+
+        template <typename NodeType>
+        static std::size_t height(const NodeType * root) noexcept {
+            return static_cast<std::size_t>(heightOf(root));
+        }
+    };
+
+    using none = basic_none<>;
+    using avl = basic_avl<>;
+    /*! none and avl, keeping subtree sizes for O(log N) rank(), select() and count_range() */
+    using ranked = basic_none<subtree_size>;
+    using ranked_avl = basic_avl<subtree_size>;
+}
+
+namespace detail {
+
+    /*! true if the nodes keep the size of their subtree */
+    template <class Meta, class = void>
+    struct has_subtree_size : std::false_type {};
+
+    template <class Meta>
+    struct has_subtree_size<Meta, std::void_t<decltype(std::declval<Meta &>().size)>> : std::true_type {};
+}
+
+/*! namespace for the policies resolving duplicate keys in Tree::merge: called as resolve(kept, other),
+    they leave in kept the value of the key. Any callable with this signature can be used */
+namespace merging {
+
+    /*! the value of the merged tree wins, as when inserting it */
+    struct overwrite {
+        template <class T>
+        void operator()(T & kept, T && other) const { kept = std::move(other); }
+    };
+
+    /*! the value already in the tree wins */
+    struct keep {
+        template <class T>
+        void operator()(T &, T &&) const noexcept {}
+    };
 }
 
 
-/*! Implements a binary search tree, templated on key and values */
-template <class K, class T>
-class Tree {
+/*! Implements a binary search tree, templated on key and values.
+    Compare orders the keys, std::less<K> by default; a transparent comparator (e.g. std::less<>) enables
+    find and erase with any type comparable with K, without building a temporary key.
+    Balance selects the balancing policy: balancing::none (default) or balancing::avl, and their
+    balancing::ranked and balancing::ranked_avl variants keeping subtree sizes for rank() and select().
+    Alloc is rebound to allocate the nodes: std::allocator (default) or pool_allocator.
+    Instrument counts the work done by the operations, see stats(): instrument::none (default) costs nothing,
+    instrument::counting keeps the counters */
+template <class K, class T, class Compare = std::less<K>, class Balance = balancing::none,
+          class Alloc = std::allocator<std::pair<const K, T>>, class Instrument = instrument::none>
+class Tree : private Instrument {
     
 
-    using Node = detail::Node<K, T>;  // to use directly Node, from detail namespace
+    using Node = detail::Node<K, T, typename Balance::node_data, key_prefix<K, Compare>>;  // to use directly Node, from detail namespace
+    using prefix_traits = key_prefix<K, Compare>;
+    using node_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using node_traits = std::allocator_traits<node_allocator>;
 
     /*! pointer to tree root node*/
-    std::unique_ptr<Node> root = nullptr;
+    Node * root = nullptr;
+
+    /*! allocator used for every node of this tree */
+    node_allocator alloc;
+
+    /*! number of nodes */
+    std::size_t nodes = 0;
+
+    /*! node with the highest key, nullptr if empty: appending keys and --end() are O(1) */
+    Node * rightmost = nullptr;
 
-    /*! recursive helper function, called by balance() function*/
-    void recursive_balancer(std::vector<typename Node::data_type>vec) {       // to do: set to private.
+    /*! node touched by the last insert_near() or find_near(), where they start searching. nullptr stands for end() */
+    mutable Node * finger = nullptr;
 
-        if (vec.size() < 3)
-        {
-            for(auto & item : vec)
-                this->insert(item.first, item.second);
+    /*! key comparison function object */
+    Compare comp;
+
+    /*! result of a descent from root looking for a key */
+    struct position {
+        Node * parent = nullptr;    // last node visited: parent of the key if it is missing
+        Node * match = nullptr;     // node holding the key, if present
+        bool left = false;          // the key belongs to the left of parent
+    };
+
+    /*! descends from root looking for key with a single comparison per level: the last node whose key
+        is not greater than key is remembered, and holds key if its key is not smaller than key either */
+    template <class Key>
+    position locate(const Key & key, instrument::operation op = instrument::operation::find) const {
+        return locate(key, root, op);
+    }
+
+    /*! as locate(key), descending from the subtree rooted in from, whose key range must hold key.
+        op tells the instrumentation which operation the descent belongs to */
+    template <class Key>
+    position locate(const Key & key, Node * from, instrument::operation op = instrument::operation::find) const {
+        if constexpr (detail::uses_prefix<prefix_traits, Key>::value) {
+            return locate_prefixed(key, from, op);
+        } else {
+            position result;
+            Node * candidate = nullptr;
+            std::size_t visited = 0;
+            for (Node * node = from; node; ++visited) {
+                result.parent = node;
+                result.left = comp(key, node->data.first);
+                if (result.left) {
+                    node = node->left;
+                } else {
+                    candidate = node;
+                    node = node->right;
+                }
+            }
+            if (candidate && !comp(candidate->data.first, key)) { result.match = candidate; }
+            this->record_descent(op, visited, visited + (candidate ? 1 : 0));
+            return result;
+        }
+    }
+
+    /*! locate() for keys with inline prefixes (see key_prefix.h): a level compares the prefix of key with
+        the one in the node, and reads the key of the node only on a tie of prefixes that are not decisive.
+        The descent stops at the node holding key */
+    template <class Key>
+    position locate_prefixed(const Key & key, Node * from, instrument::operation op) const {
+        const typename prefix_traits::view_type view(key);
+        const std::uint64_t prefix = prefix_traits::of(view);
+        position result;
+        std::size_t visited = 0;
+        std::size_t compared = 0;
+        for (Node * node = from; node; ++visited) {
+            result.parent = node;
+            if (prefix != node->prefix) {
+                result.left = prefix < node->prefix;
+            } else {
+                const int order = prefix_traits::decisive(prefix) ? 0 : (++compared, prefix_traits::compare(view, node->data.first));
+                if (order == 0) {
+                    result.match = node;
+                    ++visited;
+                    break;
+                }
+                result.left = order < 0;
+            }
+            node = result.left ? node->left : node->right;
         }
-        else
-        {
-            this->insert(vec[vec.size() / 2].first, vec[vec.size() / 2].second);
-            std::vector<typename Node::data_type> firstHalf(vec.begin(), vec.begin() + vec.size()/2);
-            std::vector<typename Node::data_type> secondHalf(vec.begin() + vec.size()/2 + 1, vec.end());
-            recursive_balancer(firstHalf);
-            recursive_balancer(secondHalf);
+        this->record_descent(op, visited, compared);
+        return result;
+    }
+
+    /*! as locate(key), starting from start instead of root (end() if nullptr). A finger search climbs from start
+        through parent pointers up to the subtree whose key range holds key, then descends from there:
+        O(log d) in a balanced tree, d being the distance in order between start and key.
+        O(1) for a key after the highest one, the common case of append mostly streams */
+    template <class Key>
+    position locate_near(Node * start, const Key & key, instrument::operation op = instrument::operation::find) const {
+        if (!root) { return {}; }
+        if (!start || start == rightmost) {
+            if (comp(rightmost->data.first, key)) { return {rightmost, nullptr, false}; }
+            start = rightmost;
+        }
+        Node * node = start;
+        if (comp(node->data.first, key)) {              // key after node: climb until an ancestor is greater than key
+            for (Node * up = node->parent; up; up = node->parent) {
+                if (node == up->left && comp(key, up->data.first)) { break; }
+                node = up;
+            }
+        } else if (comp(key, node->data.first)) {       // key before node: climb until an ancestor is smaller than key
+            for (Node * up = node->parent; up; up = node->parent) {
+                if (node == up->right && comp(up->data.first, key)) { break; }
+                node = up;
+            }
         }
+        return locate(key, node, op);
+    }
+
+    /*! links node where locate() found room for its key, then rebalances. Returns node */
+    Node * link_node(Node * node, const position & where) noexcept {
+        Node * parent = where.parent;
+        node->parent = parent;
+        if (!parent) {
+            root = rightmost = node;
+        } else if (where.left) {
+            parent->left = node;
+        } else {
+            parent->right = node;
+            if (parent == rightmost) { rightmost = node; }
+        }
+        ++nodes;
+        Balance::rebalance(parent, root);
+        return node;
+    }
+
+    /*! true if nodes keep the size of their subtree */
+    static constexpr bool sized = detail::has_subtree_size<typename Balance::node_data>::value;
+
+    /*! first node whose key is not smaller than key (Strict == false) or greater than key (Strict == true) */
+    template <bool Strict, class Key>
+    Node * bound(const Key & key) const {
+        Node * result = nullptr;
+        for (Node * node = root; node; ) {
+            if (Strict ? comp(key, node->data.first) : !comp(node->data.first, key)) {
+                result = node;
+                node = node->left;
+            } else {
+                node = node->right;
+            }
+        }
+        return result;
+    }
+
+    /*! number of keys smaller than key: O(height) with subtree sizes, O(N) otherwise */
+    template <class Key>
+    std::size_t rank_of(const Key & key) const {
+        if constexpr (sized) {
+            std::size_t result = 0;
+            for (Node * node = root; node; ) {
+                if (comp(node->data.first, key)) {
+                    result += balancing::subtree_size::sizeOf(node->left) + 1;
+                    node = node->right;
+                } else {
+                    node = node->left;
+                }
+            }
+            return result;
+        } else {
+            return static_cast<std::size_t>(std::distance(cbegin(), const_iterator(bound<false>(key), this)));
+        }
+    }
+
+    /*! allocates and constructs a node, forwarding args to the Node constructor */
+    template <class... Args>
+    Node * create_node(Args&&... args) {
+        Node * node = node_traits::allocate(alloc, 1);
+        try {
+            node_traits::construct(alloc, node, std::forward<Args>(args)...);
+        } catch (...) {
+            node_traits::deallocate(alloc, node, 1);
+            throw;
+        }
+        return node;
+    }
+
+    /*! inserts key with a value built from args, unless key is present, with a single descent.
+        key and args are forwarded to the node only if it is created */
+    template <class Key, class... Args>
+    auto emplace_key(Key && key, Args&&... args) {       // auto: iterator is declared further down
+        const auto found = locate(key, instrument::operation::insert);
+        if (found.match) { return std::pair<iterator, bool>(iterator(found.match, this), false); }
+        Node * node = create_node(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)),
+                                  std::forward_as_tuple(std::forward<Args>(args)...));
+        return std::pair<iterator, bool>(iterator(link_node(node, found), this), true);
+    }
+
+    /*! destroys a single node, children are not touched */
+    void destroy_node(Node * node) noexcept {
+        node_traits::destroy(alloc, node);
+        node_traits::deallocate(alloc, node, 1);
+    }
+
+    /*! destroys node and all its descendants without recursion: left children are rotated up
+        until the top node has none, then it is destroyed and its right child takes its place.
+        O(N) time whatever the shape of the tree. deallocate == false only runs the destructors,
+        used when the allocator frees the memory in bulk*/
+    void destroy_subtree(Node * node, bool deallocate = true) noexcept {
+        while (node) {
+            if (Node * pivot = node->left) {
+                node->left = pivot->right;
+                pivot->right = node;
+                node = pivot;
+            } else {
+                Node * next = node->right;
+                if (deallocate) { destroy_node(node); } else { node_traits::destroy(alloc, node); }
+                node = next;
+            }
+        }
+    }
+
+    /*! deep copy of a subtree, allocated with this tree allocator. Walks the source through parent pointers,
+        building the copy in lockstep, so the stack does not grow with the depth of the tree */
+    Node * clone_subtree(const Node * source) {
+        if (!source) { return nullptr; }
+        auto copy_node = [this](const Node * node) {
+            Node * copy = create_node(node->data);
+            static_cast<typename Node::meta_type &>(*copy) = *node;
+            return copy;
+        };
+        Node * const top = copy_node(source);
+        try {
+            const Node * const stop = source->parent;
+            const Node * previous = stop;
+            Node * copy = top;
+            while (true) {
+                if (previous == source->parent && source->left) {               // first visit, copy left child
+                    attachLeft(copy, copy_node(source->left));
+                    previous = source;
+                    source = source->left;
+                    copy = copy->left;
+                } else if (previous != source->right && source->right) {        // left subtree done, copy right child
+                    attachRight(copy, copy_node(source->right));
+                    previous = source;
+                    source = source->right;
+                    copy = copy->right;
+                } else if (source->parent != stop) {                            // both subtrees done, go back up
+                    previous = source;
+                    source = source->parent;
+                    copy = copy->parent;
+                } else {
+                    return top;
+                }
+            }
+        } catch (...) {
+            destroy_subtree(top);
+            throw;
+        }
+    }
+
+    /*! builds the tree, which must be empty, from a sequence sorted by key, moving the values out of
+        move iterators. With equal keys the last value wins, as with insert. The nodes are created in order
+        and linked in a vine, then folded into a complete tree: O(N), and a single slab with pool_allocator */
+    template <class ForwardIt>
+    void build_sorted(ForwardIt first, ForwardIt last) {
+        if constexpr (detail::has_reserve<node_allocator>::value) {
+            reserve_nodes(static_cast<std::size_t>(std::distance(first, last)));
+        }
+        Node * tail = nullptr;
+        try {
+            for (; first != last; ++first) {
+                auto && pair = *first;
+                if (tail && !comp(tail->data.first, pair.first)) {      // same key as the previous pair
+                    tail->data.second = std::forward<decltype(pair)>(pair).second;
+                    continue;
+                }
+                Node * node = create_node(std::forward<decltype(pair)>(pair));
+                if (tail) { attachRight(tail, node); } else { root = node; }
+                tail = node;
+                ++nodes;
+            }
+        } catch (...) {
+            clear();
+            throw;
+        }
+        rightmost = tail;
+        vineToTree(root, nodes);
+        refresh_metadata();
+    }
+
+    /*! preallocates count nodes, if the allocator supports it */
+    void reserve_nodes(std::size_t count) {
+        if constexpr (detail::has_reserve<node_allocator>::value) {
+            if (count) { alloc.reserve(count); }
+        }
+    }
+
+    /*! recomputes the balancing policy bookkeeping of every node, after the tree has been rebuilt */
+    void refresh_metadata() noexcept {
+        if constexpr (!std::is_empty<typename Balance::node_data>::value) {
+            postOrder(root, [](Node * node) { Balance::update(node); });
+        }
+    }
+
+    /*! true if nodes allocated by the allocator of a tree can be handed to another tree with a copy of it:
+        not with allocators releasing all their memory at once, as pool_allocator, since the copies share it */
+    static constexpr bool movable_nodes = node_traits::is_always_equal::value || !detail::has_release<node_allocator>::value;
+
+    /*! turns other into a vine of nodes allocated by this tree, and leaves other empty. Nodes are moved when
+        the allocators allow it, otherwise they are recreated here, moving the values, and the old ones are
+        destroyed one by one, since the memory of other may be shared. Returns the head. If a node cannot be
+        created, other is folded back into a tree, missing the values already moved, and this tree is untouched */
+    Node * take_vine(Tree & other) {
+        treeToVine(other.root);
+        Node * vine = other.root;
+        if (!movable_nodes || !(alloc == other.alloc)) {
+            Node * head = nullptr;
+            Node * tail = nullptr;
+            try {
+                for (Node * node = vine; node; node = node->right) {
+                    Node * copy = create_node(std::move(node->data));
+                    if (tail) { attachRight(tail, copy); } else { head = copy; }
+                    tail = copy;
+                }
+            } catch (...) {
+                destroy_subtree(head);
+                vineToTree(other.root, other.nodes);
+                other.refresh_metadata();
+                throw;
+            }
+            other.destroy_subtree(vine);
+            vine = head;
+        }
+        other.root = other.rightmost = other.finger = nullptr;
+        other.nodes = 0;
+        return vine;
+    }
+
+    /*! makes the vine of count nodes starting at head, ending at tail, the whole tree: folded into a complete tree */
+    void adopt_vine(Node * head, Node * tail, std::size_t count) noexcept {
+        if (head) { head->parent = nullptr; }
+        if (tail) { tail->right = nullptr; }
+        root = head;
+        nodes = count;
+        rightmost = tail;
+        finger = nullptr;
+        vineToTree(root, count);
+        refresh_metadata();
+    }
+
+    /*! below this number of nodes the parallel algorithms run serially */
+    static constexpr std::size_t parallel_cutoff = std::size_t{1} << 14;
+
+    /*! part of a parallel scan: the whole subtree of node, or node alone */
+    struct scan_piece {
+        Node * node;
+        bool whole;
+    };
+
+    /*! splits the nodes with keys in [*lo, *hi), a missing bound being unbounded, in pieces listed in order
+        of key: single nodes of the top levels of the tree, and the subtrees below them, about 2^levels.
+        Subtrees out of the range are left out; the ones at its ends may hold keys outside it */
+    std::vector<scan_piece> scan_pieces(std::size_t levels, const K * lo, const K * hi) const {
+        std::vector<scan_piece> pieces;
+        auto split = [&](auto & self, Node * node, std::size_t depth) -> void {
+            if (!node) { return; }
+            if (depth == 0) {
+                pieces.push_back({node, true});
+                return;
+            }
+            const bool above_lo = !lo || !comp(node->data.first, *lo);
+            const bool below_hi = !hi || comp(node->data.first, *hi);
+            if (above_lo) { self(self, node->left, depth - 1); }
+            if (above_lo && below_hi) { pieces.push_back({node, false}); }
+            if (below_hi) { self(self, node->right, depth - 1); }
+        };
+        split(split, root, levels);
+        return pieces;
+    }
+
+    /*! calls f on the pairs of piece with keys in [*lo, *hi), in order of key */
+    template <class F>
+    void scan(const scan_piece & piece, const K * lo, const K * hi, F & f) const {
+        if (!piece.whole) {
+            f(piece.node->data);
+            return;
+        }
+        const Node * node = piece.node;
+        if (lo) {                               // the first key not smaller than lo in the subtree
+            const Node * first = nullptr;
+            while (node) {
+                if (comp(node->data.first, *lo)) {
+                    node = node->right;
+                } else {
+                    first = node;
+                    node = node->left;
+                }
+            }
+            node = first;
+        } else {
+            node = allLeft(node);
+        }
+        const Node * const last = allRight(piece.node);
+        for (; node; node = node == last ? nullptr : successor(node)) {
+            if (hi && !comp(node->data.first, *hi)) { return; }
+            f(node->data);
+        }
+    }
+
+    /*! levels of a split in about 8 pieces per thread of pool; none, a single piece, below parallel_cutoff nodes */
+    std::size_t scan_levels(const thread_pool & pool, std::size_t per_thread = 8) const {
+        if (nodes < parallel_cutoff || pool.size() < 2) { return 0; }
+        std::size_t levels = 3;
+        while ((std::size_t{1} << levels) < per_thread * pool.size()) { ++levels; }
+        return levels;
+    }
+
+    /*! fills out with the pointers to every node, in order of key: the pieces of scan_pieces() are counted,
+        then walked, in parallel */
+    void collect_in_order(thread_pool & pool, Node ** out) const {
+        const auto pieces = scan_pieces(scan_levels(pool), nullptr, nullptr);
+        std::vector<std::size_t> counts(pieces.size(), 1);
+        detail::parallelFor(pool, 0, pieces.size(), [&pieces, &counts](std::size_t i) {
+            if (pieces[i].whole) {
+                counts[i] = 0;
+                postOrder(pieces[i].node, [&counts, i](Node *) { ++counts[i]; });
+            }
+        });
+        std::vector<std::size_t> offsets(pieces.size());
+        for (std::size_t i = 1; i < pieces.size(); ++i) { offsets[i] = offsets[i - 1] + counts[i - 1]; }
+        detail::parallelFor(pool, 0, pieces.size(), [&pieces, &counts, &offsets, out](std::size_t i) {
+            Node * node = pieces[i].whole ? allLeft(pieces[i].node) : pieces[i].node;
+            for (std::size_t k = 0; k < counts[i]; ++k, node = successor(node)) { out[offsets[i] + k] = node; }
+        });
+    }
+
+    template <class F>
+    void for_each_in(thread_pool & pool, const K * lo, const K * hi, F & f) const {
+        const auto pieces = scan_pieces(scan_levels(pool), lo, hi);
+        detail::parallelFor(pool, 0, pieces.size(), [&](std::size_t i) { scan(pieces[i], lo, hi, f); });
+    }
+
+    template <class R, class Combine, class Map>
+    R reduce_in(thread_pool & pool, const K * lo, const K * hi, R init, Combine & combine, Map & map) const {
+        const auto pieces = scan_pieces(scan_levels(pool), lo, hi);
+        std::vector<R> partial(pieces.size(), init);
+        detail::parallelFor(pool, 0, pieces.size(), [&](std::size_t i) {
+            auto accumulate = [&partial, &combine, &map, i](const typename Node::data_type & pair) {
+                partial[i] = combine(std::move(partial[i]), map(pair));
+            };
+            scan(pieces[i], lo, hi, accumulate);
+        });
+        for (auto & value : partial) { init = combine(std::move(init), std::move(value)); }
+        return init;
+    }
+
+    template <class Map, class Sink>
+    void ordered_in(thread_pool & pool, const K * lo, const K * hi, Map & map, Sink & sink) const {
+        using result_type = std::decay_t<decltype(map(std::declval<const typename Node::data_type &>()))>;
+        using entry = std::pair<const typename Node::data_type *, result_type>;
+        const std::size_t levels = scan_levels(pool, 64);
+        if (levels == 0) {                      // serial: no results kept
+            auto direct = [&map, &sink](const typename Node::data_type & pair) { sink(pair, map(pair)); };
+            if (root) { scan(scan_piece{root, true}, lo, hi, direct); }
+            return;
+        }
+        const auto pieces = scan_pieces(levels, lo, hi);
+        const std::size_t window = pool.size();
+        std::vector<std::vector<entry>> ready(window), next(window);
+        auto compute = [&](std::vector<std::vector<entry>> & out, std::size_t first) {
+            const std::size_t count = std::min(window, pieces.size() - std::min(first, pieces.size()));
+            detail::parallelFor(pool, 0, count, [&](std::size_t i) {
+                out[i].clear();
+                auto record = [&out, &map, i](const typename Node::data_type & pair) { out[i].emplace_back(&pair, map(pair)); };
+                scan(pieces[first + i], lo, hi, record);
+            });
+            return count;
+        };
+        std::size_t filled = compute(ready, 0);
+        for (std::size_t first = 0; first < pieces.size(); first += window) {
+            std::size_t computed = 0;
+            pool.invoke([&] {
+                for (std::size_t i = 0; i < filled; ++i) {
+                    for (auto & item : ready[i]) { sink(*item.first, std::move(item.second)); }
+                }
+            }, [&] { computed = compute(next, first + window); });
+            std::swap(ready, next);
+            filled = computed;
+        }
+    }
+
+    /*! links the nodes in [first, last), sorted by key, in a tree of minimum height under parent, and returns
+        its root. The two halves are linked in parallel above parallel_cutoff nodes */
+    Node * link_sorted(thread_pool & pool, Node ** first, Node ** last, Node * parent) {
+        if (first == last) { return nullptr; }
+        Node ** middle = first + (last - first) / 2;
+        Node * node = *middle;
+        node->parent = parent;
+        if (static_cast<std::size_t>(last - first) > parallel_cutoff) {
+            pool.invoke([&] { node->left = link_sorted(pool, first, middle, node); },
+                        [&] { node->right = link_sorted(pool, middle + 1, last, node); });
+        } else {
+            node->left = link_sorted(pool, first, middle, node);
+            node->right = link_sorted(pool, middle + 1, last, node);
+        }
+        Balance::update(node);
+        return node;
+    }
+
+    /*! builds a tree of minimum height under parent from [first, last), sorted by key without duplicates,
+        creating the two halves in parallel above parallel_cutoff nodes; values are moved out of move iterators.
+        Returns its root. Only used with stateless allocators, which can be called from any thread */
+    template <class RandomIt>
+    Node * build_parallel(thread_pool & pool, RandomIt first, RandomIt last, Node * parent) {
+        if (first == last) { return nullptr; }
+        const RandomIt middle = first + (last - first) / 2;
+        Node * node = create_node(*middle);
+        node->parent = parent;
+        try {
+            if (static_cast<std::size_t>(last - first) > parallel_cutoff) {
+                pool.invoke([&] { node->left = build_parallel(pool, first, middle, node); },
+                            [&] { node->right = build_parallel(pool, middle + 1, last, node); });
+            } else {
+                node->left = build_parallel(pool, first, middle, node);
+                node->right = build_parallel(pool, middle + 1, last, node);
+            }
+        } catch (...) {                 // a failed half has already freed its nodes
+            destroy_subtree(node->left);
+            destroy_subtree(node->right);
+            destroy_node(node);
+            throw;
+        }
+        Balance::update(node);
+        return node;
     }
 
 
@@ -131,23 +964,93 @@ public:
     /*! constructor */
     Tree (){};
 
+    /*! constructor with a given comparator and allocator */
+    explicit Tree (const Compare & compare, const Alloc & allocator = Alloc())
+    : alloc(allocator),
+      comp(compare)
+    {};
+
+    /*! constructor with a given allocator */
+    explicit Tree (const Alloc & allocator)
+    : alloc(allocator)
+    {};
+
+    /*! constructor from a range of key-value pairs, see insert(first, last) */
+    template <class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+    Tree (InputIt first, InputIt last, const Compare & compare = Compare(), const Alloc & allocator = Alloc())
+    : alloc(allocator),
+      comp(compare)
+    {
+        insert(first, last);
+    };
+
+    /*! constructor from a list of key-value pairs, e.g. Tree<int, char> tree{{1, 'a'}, {2, 'b'}} */
+    Tree (std::initializer_list<std::pair<const K, T>> list, const Compare & compare = Compare(),
+          const Alloc & allocator = Alloc())
+    : Tree(list.begin(), list.end(), compare, allocator)
+    {};
+
     /*! Move constructor*/
-    Tree ( Tree <K,T>&& other) noexcept = default;
+    Tree ( Tree && other) noexcept
+    : root(std::exchange(other.root, nullptr)),
+      alloc(std::move(other.alloc)),
+      nodes(std::exchange(other.nodes, 0)),
+      rightmost(std::exchange(other.rightmost, nullptr)),
+      finger(std::exchange(other.finger, nullptr)),
+      comp(other.comp)
+    {};
     
-    /*! Copy assignment */
-    Tree & operator=(Tree&& bt) noexcept = default;
-    Tree & operator=(const Tree& bt) noexcept = default;
+    /*! Move assignment: steals the nodes when the allocators allow it, otherwise moves the values */
+    Tree & operator=(Tree&& bt) noexcept(node_traits::propagate_on_container_move_assignment::value
+                                         || node_traits::is_always_equal::value) {
+        if (this == &bt) { return *this; }
+        clear();
+        comp = bt.comp;
+        if constexpr (node_traits::propagate_on_container_move_assignment::value) {
+            alloc = std::move(bt.alloc);
+        } else if (!(alloc == bt.alloc)) {
+            for (auto & item : bt) { insert(item.first, std::move(item.second)); }
+            bt.clear();
+            return *this;
+        }
+        root = std::exchange(bt.root, nullptr);
+        nodes = std::exchange(bt.nodes, 0);
+        rightmost = std::exchange(bt.rightmost, nullptr);
+        finger = std::exchange(bt.finger, nullptr);
+        return *this;
+    }
+
+    /*! Copy assignment: deep copy, without recursion. If copying throws the tree is left empty */
+    Tree & operator=(const Tree& bt) {
+        if (this == &bt) { return *this; }
+        clear();
+        comp = bt.comp;
+        if constexpr (node_traits::propagate_on_container_copy_assignment::value) {
+            alloc = bt.alloc;
+        }
+        reserve_nodes(bt.nodes);
+        root = clone_subtree(bt.root);
+        nodes = bt.nodes;
+        rightmost = root ? allRight(root) : nullptr;
+        return *this;
+    }
 
-    /*! Copy constructor */
+    /*! Copy constructor: deep copy, without recursion. Pool allocators get room for all the nodes at once */
     Tree (const Tree & other)
-    : root(clone(other.root.get())),
-      height(other.height) 
-    {};
+    : Instrument(),
+      alloc(node_traits::select_on_container_copy_construction(other.alloc)),
+      comp(other.comp)
+    {
+        reserve_nodes(other.nodes);
+        root = clone_subtree(other.root);
+        nodes = other.nodes;
+        rightmost = root ? allRight(root) : nullptr;
+    };
         
     
 
-    /*! default destructor */
-    ~Tree() noexcept = default;
+    /*! destructor, frees every node */
+    ~Tree() noexcept { clear(); }
 
 
 
@@ -156,8 +1059,20 @@ public:
         return root == nullptr;
     }
 
-    /*! Returns tree height */
-    size_t height = 0;
+    /*! Returns the number of nodes */
+    std::size_t size() const noexcept {
+        return nodes;
+    }
+
+    /*! Returns the key comparison function object */
+    Compare key_comp() const {
+        return comp;
+    }
+
+    /*! Returns tree height: the number of nodes on the longest path from root to a leaf */
+    std::size_t height() const noexcept {
+        return Balance::height(root);
+    }
 
 
 
@@ -167,7 +1082,7 @@ public:
     template <bool Const>
     class iterator_template {
     public:
-        using iterator_category = std::forward_iterator_tag;
+        using iterator_category = std::bidirectional_iterator_tag;
         using value_type = decltype(Node::data);
         using difference_type = std::ptrdiff_t; //  is the signed integer type of the result of subtracting two pointers. 
         using reference = typename std::conditional_t<Const, const value_type &, value_type &>;  // conditional_t provides member typedef type, which is defined as T1 if B is true at compile time, or as T2 if B is false.
@@ -175,10 +1090,14 @@ public:
 
     public :
         iterator_template() = default;
-        explicit iterator_template(Node * ptr) : itr(ptr) {}
-
-        reference operator*() { return itr->data; };
-        pointer operator->() { return &itr->data; }
+        /*! iterator to ptr, end() if nullptr; owner is needed to step back from end() */
+        iterator_template(Node * ptr, const Tree * owner) : itr(ptr), tree(owner) {}
+        /*! conversion from iterator to const_iterator */
+        template <bool WasConst, class = std::enable_if_t<Const && !WasConst>>
+        iterator_template(const iterator_template<WasConst> & other) : itr(other.itr), tree(other.tree) {}
+
+        reference operator*() const { return itr->data; }
+        pointer operator->() const { return &itr->data; }
         iterator_template & operator++() {
             itr = successor(itr);
             return *this;
@@ -188,6 +1107,16 @@ public:
             ++(*this);
             return old;
         }
+        /*! steps to the previous node; from end() to the node with the highest key */
+        iterator_template & operator--() {
+            itr = itr ? predecessor(itr) : tree->rightmost;
+            return *this;
+        }
+        iterator_template operator--(int) {
+            auto old = *this;
+            --(*this);
+            return old;
+        }
         friend bool operator== (const iterator_template<Const> & lhs, const iterator_template<Const> & rhs) {
             return lhs.itr == rhs.itr;
         };
@@ -197,130 +1126,274 @@ public:
     
         Node * get_node() const { return itr; }
     protected:       // allows inheritance
+        template <bool> friend class iterator_template;
         Node * itr = nullptr;
+        const Tree * tree = nullptr;
     };
 
 
     
     using iterator = iterator_template<false>;   // creates iterators
     using const_iterator = iterator_template<true>; // creates const_iterators
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
 ////////////////////// end iterators ///////////////////////////////////
 // detail:: is automatically called by ADL (see Koenig lookup)
 
     
     /*! iterator to the node with the lowest key*/
-    iterator       begin()        { return iterator(allLeft(root.get())); }
+    iterator       begin()        { return iterator(root ? allLeft(root) : nullptr, this); }
     /*! iterator to the node with the lowest key, for const Trees*/
-    const_iterator begin()  const { return const_iterator(allLeft(root.get())); }
+    const_iterator begin()  const { return const_iterator(root ? allLeft(root) : nullptr, this); }
     /*! const iterator to the node with the lowest key, for const Trees*/
-    const_iterator cbegin() const { return const_iterator(allLeft(root.get())); }
+    const_iterator cbegin() const { return const_iterator(root ? allLeft(root) : nullptr, this); }
 
     /*! iterator to the node after the one with the highest key (so nullptr)*/
-    iterator       end()          { return iterator(nullptr); }
+    iterator       end()          { return iterator(nullptr, this); }
     /*! iterator to the node after the one with the highest key (so nullptr), for const Trees*/
-    const_iterator end()  const   { return const_iterator(nullptr);}
+    const_iterator end()  const   { return const_iterator(nullptr, this);}
     /*! const iterator to the node after the one with the highest key (so nullptr), for const Trees*/
-    const_iterator cend() const   { return const_iterator(nullptr); }
+    const_iterator cend() const   { return const_iterator(nullptr, this); }
 
-    void insert(const K key, const T value) { /*! add a node provided key and value compatible with the tree */
+    /*! reverse iterators, from the node with the highest key down to the lowest */
+    reverse_iterator       rbegin()        { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin()  const { return const_reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const { return const_reverse_iterator(cend()); }
+    reverse_iterator       rend()          { return reverse_iterator(begin()); }
+    const_reverse_iterator rend()    const { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crend()   const { return const_reverse_iterator(cbegin()); }
+
+    std::pair<iterator, bool> insert(const K & key, const T & value) { /*! add a node provided key and value compatible with the tree */
 
        /* @brief
         *
         * input: K key, T value. Must match tree K and T types.
-        * output: none
+        * output: iterator to the node holding key, and true if it was created
         * actions: if root is nullptr, set the new node as root.
-        * otherwise, recursively compares keys.
+        * otherwise, descends comparing keys, once per level (see locate()).
         * if equal, overwrites value.
-        * if less or greater, recursively calls itself respectively on left or right child
-        *
+        * if missing, attaches a new node on the left or right of the last node visited,
+        * then lets the balancing policy restore its invariants on the way back to root
         *
         */
-        Node * current = root.get();
-        Node * parent = nullptr;
+        return insert_or_assign(key, value);
+    };
 
-        size_t temp_height = 0;
-        while (current) {
-            parent = current;
-            if (key > current->data.first) {
-                current = current->right.get();
-                temp_height++;
-                if (temp_height > this->height) { this->height = temp_height;}
-            } else if (key < current->data.first) {
-                current = current->left.get();
-                temp_height++;
-                if (temp_height > this->height) { this->height = temp_height;}
-            } else {
-                current->data.second = value;
+    /*! as insert(key, value), moving value into the tree */
+    std::pair<iterator, bool> insert(const K & key, T && value) {
+        return insert_or_assign(key, std::move(value));
+    }
+
+    /*! inserts key with value, or assigns value to the key already present, with a single descent.
+        value is forwarded: an rvalue is moved, never copied. Returns an iterator to the node holding key,
+        and true if it was inserted */
+    template <class M>
+    std::pair<iterator, bool> insert_or_assign(const K & key, M && value) {
+        auto result = emplace_key(key, std::forward<M>(value));
+        if (!result.second) { result.first->second = std::forward<M>(value); }
+        return result;
+    }
+    template <class M>
+    std::pair<iterator, bool> insert_or_assign(K && key, M && value) {
+        auto result = emplace_key(std::move(key), std::forward<M>(value));
+        if (!result.second) { result.first->second = std::forward<M>(value); }
+        return result;
+    }
+
+    /*! inserts key with a value constructed in place from args, only if key is missing, with a single descent.
+        If key is present neither key nor args are moved from. Returns an iterator to the node holding key,
+        and true if it was inserted */
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(const K & key, Args&&... args) {
+        return emplace_key(key, std::forward<Args>(args)...);
+    }
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(K && key, Args&&... args) {
+        return emplace_key(std::move(key), std::forward<Args>(args)...);
+    }
+
+    /*! constructs a pair from args, forwarded to the Node constructor, and inserts it, as in std::map:
+        an existing value is left untouched and the new node destroyed. Prefer try_emplace(), which builds
+        nothing when the key is present. Returns an iterator to the node holding the key, and true if inserted */
+    template <class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        Node * node = create_node(std::forward<Args>(args)...);
+        const auto found = locate(node->data.first, instrument::operation::insert);
+        if (found.match) {
+            destroy_node(node);
+            return {iterator(found.match, this), false};
+        }
+        return {iterator(link_node(node, found), this), true};
+    }
+
+    /*! value of key, inserting a value initialized one if key is missing, with a single descent:
+        tree[key] += x costs one search */
+    T & operator[](const K & key) {
+        return emplace_key(key).first->second;
+    }
+    T & operator[](K && key) {
+        return emplace_key(std::move(key)).first->second;
+    }
+
+    /*! value of key in a const tree, which cannot insert it: throws std::out_of_range if key is missing */
+    const T & operator[](const K & key) const {
+        const Node * node = locate(key).match;
+        if (!node) { throw std::out_of_range("Tree::operator[]: key not found"); }
+        return node->data.second;
+    }
+
+    /*! insert with a hint, as in std::map: the search starts from hint instead of root (see locate_near), so keys
+        close in order to hint cost O(log d), and keys after the highest one O(1): pass end(), or the iterator
+        returned by the previous call, when keys arrive nearly sorted. Overwrites the value if the key is
+        already present, as insert(key, value). Returns an iterator to the node holding key */
+    iterator insert(const_iterator hint, const K & key, const T & value) {
+        const auto found = locate_near(hint.get_node(), key, instrument::operation::insert);
+        if (found.match) {
+            found.match->data.second = value;
+            return iterator(found.match, this);
+        }
+        return iterator(link_node(create_node(key, value), found), this);
+    }
+
+    /*! constructs a pair from args, forwarded to the Node constructor, and inserts it searching from hint,
+        see insert(hint, key, value). As in std::map an existing value is left untouched.
+        Returns an iterator to the node holding the key */
+    template <class... Args>
+    iterator emplace_hint(const_iterator hint, Args&&... args) {
+        Node * node = create_node(std::forward<Args>(args)...);
+        const auto found = locate_near(hint.get_node(), node->data.first, instrument::operation::insert);
+        if (found.match) {
+            destroy_node(node);
+            return iterator(found.match, this);
+        }
+        return iterator(link_node(node, found), this);
+    }
+
+    /*! insert starting from the finger, the node touched by the previous insert_near() or find_near(),
+        which then points to the new node. Meant for streams of keys close to each other */
+    void insert_near(const K & key, const T & value) {
+        finger = insert(const_iterator(finger, this), key, value).get_node();
+    }
+
+    /*! inserts a range of key-value pairs; values are moved when the range is wrapped in std::make_move_iterator.
+        Into an empty tree the pairs are loaded in O(N), producing a balanced tree: directly if the range
+        is already sorted by key, after moving them in a vector and sorting it otherwise.
+        A non empty tree inserts them one by one */
+    template <class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+    void insert(InputIt first, InputIt last) {
+        using category = typename std::iterator_traits<InputIt>::iterator_category;
+        auto by_key = [this](const auto & lhs, const auto & rhs) { return comp(lhs.first, rhs.first); };
+
+        if (!empty()) {
+            for (; first != last; ++first) {
+                auto && pair = *first;
+                insert(pair.first, std::forward<decltype(pair)>(pair).second);
+            }
+            return;
+        }
+        if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value) {
+            if (std::is_sorted(first, last, by_key)) {
+                build_sorted(first, last);
                 return;
             }
         }
+        std::vector<std::pair<K, T>> sorted(first, last);
+        std::stable_sort(sorted.begin(), sorted.end(), by_key);   // stable: the last of equal keys wins
+        build_sorted(std::make_move_iterator(sorted.begin()), std::make_move_iterator(sorted.end()));
+    }
 
-        auto newNode = std::make_unique<Node>(key, value);
-        current = newNode.get();
-        if (parent) {
-            newNode->parent = parent;
-            if (newNode->data.first > parent->data.first) {
-                parent->right = std::move(newNode);
-                // std::cout <<"created node (" <<std::setw(3) <<key
-                //           <<", " <<std::setw(3) <<value <<") [" <<current
-                //           <<"] on right of " <<parent->key <<std::endl;
-            } else {
-                parent->left = std::move(newNode);
-                // std::cout <<"created node (" <<std::setw(3) <<key
-                //           <<", " <<std::setw(3) <<value <<") [" <<current
-                //           <<"] on left of " <<parent->key <<std::endl;
-            }
+    /*! inserts a list of key-value pairs */
+    void insert(std::initializer_list<std::pair<const K, T>> list) {
+        insert(list.begin(), list.end());
+    }
+
+    /*! inserts a range of key-value pairs as insert(first, last), using the threads of pool. Into an empty tree
+        the pairs are moved in a vector, sorted with a parallel merge sort, and linked in a balanced tree whose
+        two halves are built in parallel, down to parallel_cutoff nodes. With a stateful allocator, such as
+        pool_allocator, the nodes are created serially. A non empty tree inserts them one by one */
+    template <class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+    void insert(thread_pool & pool, InputIt first, InputIt last) {
+        if (!empty() || pool.size() < 2) {
+            insert(first, last);
+            return;
+        }
+        auto by_key = [this](const auto & lhs, const auto & rhs) { return comp(lhs.first, rhs.first); };
+        std::vector<std::pair<K, T>> sorted(first, last);
+        detail::parallelStableSort(pool, sorted.begin(), sorted.end(), by_key, parallel_cutoff);
+
+        auto kept = sorted.begin();                 // of equal keys, keep the last one, as insert does
+        for (auto it = sorted.begin(); it != sorted.end(); ++it) {
+            if (std::next(it) != sorted.end() && !comp(it->first, std::next(it)->first)) { continue; }
+            if (kept != it) { *kept = std::move(*it); }
+            ++kept;
+        }
+        sorted.erase(kept, sorted.end());
+
+        if constexpr (node_traits::is_always_equal::value) {
+            root = build_parallel(pool, std::make_move_iterator(sorted.begin()), std::make_move_iterator(sorted.end()), nullptr);
+            nodes = sorted.size();
+            rightmost = root ? allRight(root) : nullptr;
         } else {
-            root = std::move(newNode);
-            // std::cout <<"created node (" <<std::setw(3) <<key
-            //           <<", " <<std::setw(3) <<value <<") [" <<current
-            //           <<"] at root" <<std::endl;
+            build_sorted(std::make_move_iterator(sorted.begin()), std::make_move_iterator(sorted.end()));
         }
-        return;
-    };
+    }
 
     void erase(iterator it) {
         auto * node = it.get_node();
+        auto * parent = node->parent;
+        auto * rebalanceFrom = parent;     // lowest node whose subtree changed
 
-        std::unique_ptr<Node> replacement;
+        Node * replacement = nullptr;
 
         if (node->left && node->right) {     // node has two children
-            auto * right = node->right.get();
-            auto * replacementPtr = allLeft(right);
+            auto * right = node->right;
+            replacement = allLeft(right);
 
             // extract replacement from tree
-            if (replacementPtr == right) {      // replacement is immediate right child
-                replacement = std::move(node->right);
-                attachRight(node, std::move(replacement->right));
+            if (replacement == right) {      // replacement is immediate right child
+                rebalanceFrom = replacement;
             } else {                            // replacement is deeper
-                replacement = std::move(replacementPtr->parent->left);
-                attachLeft(replacement->parent, std::move(replacement->right));
+                rebalanceFrom = replacement->parent;
+                attachLeft(replacement->parent, replacement->right);
+                attachRight(replacement, node->right);
             }
 
-            // steal old node children
-            attachLeft(replacement.get(), std::move(node->left));
-            attachRight(replacement.get(), std::move(node->right));
+            // steal old node left child and bookkeeping
+            attachLeft(replacement, node->left);
+            static_cast<typename Node::meta_type &>(*replacement) = *node;
 
         } else if (node->left) {            // node only has left child
-            replacement = std::move(node->left);
+            replacement = node->left;
         } else if (node->right) {           // node only has right child
-            replacement = std::move(node->right);
+            replacement = node->right;
         }
 
+        if (node == rightmost) { rightmost = predecessor(node); }
+        if (node == finger) { finger = nullptr; }
+
         // Insert replacement into the tree
-        if (!node->parent) {
-            root = std::move(replacement);
-        } else if (node->parent->left.get() == node) {
-            attachLeft(node->parent, std::move(replacement));
+        if (replacement) { replacement->parent = parent; }
+        if (!parent) {
+            root = replacement;
+        } else if (parent->left == node) {
+            parent->left = replacement;
         } else {
-            attachRight(node->parent, std::move(replacement));
+            parent->right = replacement;
         }
+        destroy_node(node);
+        --nodes;
+        Balance::rebalance(rebalanceFrom, root);
     }
 
-    void erase(K k) {/*! remove the node corresponding to the given key */
-        auto it = find(k);
-        if (it != end()) { erase(it); }
+    void erase(const K & k) {/*! remove the node corresponding to the given key */
+        if (Node * node = locate(k, instrument::operation::erase).match) { erase(iterator(node, this)); }
+    }
+
+    /*! remove the node with a key equivalent to k, only available with a transparent comparator */
+    template <class Key, class C = Compare, class = typename C::is_transparent>
+    void erase(const Key & k) {
+        if (Node * node = locate(k, instrument::operation::erase).match) { erase(iterator(node, this)); }
     }
 
     void listNodes() {                      /*! iterates the tree in order, printing key-value entries */
@@ -330,34 +1403,402 @@ public:
         };
     };
 
-    iterator find(K k) const {   /*! traverse the tree looking for a key, otherwise return nullptr iterator, that is the same as end()*/
-        auto * node = root.get();
-        while (node && node->data.first != k) {
-            node = (k < node->data.first ? node->left : node->right).get();
+    iterator find(const K & k) const {   /*! traverse the tree looking for a key, otherwise return nullptr iterator, that is the same as end()*/
+        return iterator(locate(k).match, this);
+    }
+
+    /*! find with a key of any type comparable with K, only available with a transparent comparator */
+    template <class Key, class C = Compare, class = typename C::is_transparent>
+    iterator find(const Key & k) const {
+        return iterator(locate(k).match, this);
+    }
+
+    /*! find searching from hint instead of root, see insert(hint, key, value) */
+    iterator find(const_iterator hint, const K & k) const {
+        return iterator(locate_near(hint.get_node(), k).match, this);
+    }
+
+    /*! find starting from the finger, see insert_near(). A key found becomes the new finger */
+    iterator find_near(const K & k) const {
+        auto it = find(const_iterator(finger, this), k);
+        if (it != end()) { finger = it.get_node(); }
+        return it;
+    }
+
+    /*! looks up every key of [first, last) and writes the iterators to out, end() for the missing ones.
+        Group searches advance in lockstep, one level at a time, and the next node of each one is prefetched:
+        the cache misses of the group overlap instead of stalling one after the other, which pays off on trees
+        much larger than the cache. Group is the number of searches in flight. Returns the end of the output */
+    template <std::size_t Group = 16, class ForwardIt, class OutputIt>
+    OutputIt find_batch(ForwardIt first, ForwardIt last, OutputIt out) const {
+        static_assert(Group > 0, "find_batch needs at least one search in flight");
+        ForwardIt keys[Group];
+        Node * current[Group];
+        Node * candidate[Group];
+        while (first != last) {
+            std::size_t count = 0;
+            for (; count < Group && first != last; ++count, ++first) {
+                keys[count] = first;
+                current[count] = root;
+                candidate[count] = nullptr;
+            }
+            for (std::size_t active = root ? count : 0; active; ) {
+                active = 0;
+                for (std::size_t i = 0; i < count; ++i) {
+                    Node * node = current[i];
+                    if (!node) { continue; }
+                    if (comp(*keys[i], node->data.first)) {
+                        node = node->left;
+                    } else {
+                        candidate[i] = node;
+                        node = node->right;
+                    }
+                    current[i] = node;
+                    if (node) {
+                        detail::prefetch(node);
+                        ++active;
+                    }
+                }
+            }
+            for (std::size_t i = 0; i < count; ++i, ++out) {
+                Node * match = candidate[i] && !comp(candidate[i]->data.first, *keys[i]) ? candidate[i] : nullptr;
+                *out = iterator(match, this);
+            }
+        }
+        return out;
+    }
+
+    /*! iterator to the first node whose key is not smaller than k, end() if none */
+    iterator lower_bound(const K & k) const { return iterator(bound<false>(k), this); }
+
+    template <class Key, class C = Compare, class = typename C::is_transparent>
+    iterator lower_bound(const Key & k) const { return iterator(bound<false>(k), this); }
+
+    /*! iterator to the first node whose key is greater than k, end() if none */
+    iterator upper_bound(const K & k) const { return iterator(bound<true>(k), this); }
+
+    template <class Key, class C = Compare, class = typename C::is_transparent>
+    iterator upper_bound(const Key & k) const { return iterator(bound<true>(k), this); }
+
+    /*! range of the nodes with key equivalent to k: empty, or holding a single node */
+    std::pair<iterator, iterator> equal_range(const K & k) const { return {lower_bound(k), upper_bound(k)}; }
+
+    template <class Key, class C = Compare, class = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const Key & k) const { return {lower_bound(k), upper_bound(k)}; }
+
+    /*! number of nodes with key k: 0 or 1 */
+    std::size_t count(const K & k) const { return locate(k).match ? 1 : 0; }
+
+    template <class Key, class C = Compare, class = typename C::is_transparent>
+    std::size_t count(const Key & k) const { return locate(k).match ? 1 : 0; }
+
+    /*! number of keys smaller than k, i.e. the position k has or would have in order.
+        O(height) with the ranked policies, O(N) otherwise */
+    std::size_t rank(const K & k) const { return rank_of(k); }
+
+    template <class Key, class C = Compare, class = typename C::is_transparent>
+    std::size_t rank(const Key & k) const { return rank_of(k); }
+
+    /*! number of keys in [first, last). O(height) with the ranked policies, O(N) otherwise */
+    std::size_t count_range(const K & first, const K & last) const {
+        if (!comp(first, last)) { return 0; }
+        return rank_of(last) - rank_of(first);
+    }
+
+    /*! iterator to the node with the given position in order (the index-th smallest key, from 0),
+        end() if index >= size(). O(height) with the ranked policies, O(N) otherwise */
+    iterator select(std::size_t index) const {
+        if (index >= nodes) { return iterator(nullptr, this); }
+        if constexpr (sized) {
+            Node * node = root;
+            while (true) {
+                const std::size_t left = balancing::subtree_size::sizeOf(node->left);
+                if (index < left) {
+                    node = node->left;
+                } else if (index > left) {
+                    index -= left + 1;
+                    node = node->right;
+                } else {
+                    return iterator(node, this);
+                }
+            }
+        } else {
+            return std::next(iterator(allLeft(root), this), static_cast<std::ptrdiff_t>(index));
         }
-        return iterator(node);
     }
-    /*! tree deletion: sets root to nullptr, destroy recursively all nodes*/
-    void clear(){
+    /*! tree deletion: sets root to nullptr, destroys all nodes in O(N) without recursion.
+        Allocators able to release their memory in bulk (pool_allocator) do it in one go,
+        skipping the walk entirely when nodes are trivially destructible, unless the pool is shared
+        with another allocator, e.g. another tree built from the same allocator: then nodes are freed one by one*/
+    void clear() noexcept {
+        if constexpr (detail::has_release<node_allocator>::value) {
+            if (alloc.sole_owner()) {
+                if constexpr (!std::is_trivially_destructible<Node>::value) { destroy_subtree(root, false); }
+                alloc.release();
+            } else {
+                destroy_subtree(root);
+            }
+        } else {
+            destroy_subtree(root);
+        }
         this->root = nullptr;
+        this->nodes = 0;
+        this->rightmost = this->finger = nullptr;
+    }
+
+
+
+    /*! moves every node of other into this tree, which is rebuilt balanced: the two sorted sequences are merged
+        in O(N + M), relinking the nodes without copying the values. For a key present in both trees
+        resolve(value here, value of other) decides the value kept: merging::overwrite (default), as insert does,
+        merging::keep, or any callable. Nodes are recreated, moving the values, when the allocators are different
+        or share their memory, as pool_allocator. other is left empty. If resolve throws, both trees are left empty;
+        if recreating the nodes of other throws, this tree is left untouched */
+    template <class Resolve = merging::overwrite>
+    void merge(Tree && other, Resolve resolve = Resolve()) {
+        if (this == &other || other.empty()) { return; }
+        Node * b = take_vine(other);            // may throw: this tree is linearized only after it
+        treeToVine(root);
+        Node * a = root;
+        root = nullptr;
+
+        Node * head = nullptr;
+        Node * tail = nullptr;
+        std::size_t count = 0;
+        try {
+            while (a || b) {
+                Node * next;
+                if (!b || (a && comp(a->data.first, b->data.first))) {
+                    next = a;
+                    a = a->right;
+                } else if (!a || comp(b->data.first, a->data.first)) {
+                    next = b;
+                    b = b->right;
+                } else {                                // same key: one node is left
+                    resolve(a->data.second, std::move(b->data.second));    // if it throws, b still owns the node
+                    Node * duplicate = b;
+                    b = b->right;
+                    destroy_node(duplicate);
+                    continue;
+                }
+                next->left = nullptr;
+                if (tail) { attachRight(tail, next); } else { head = next; }
+                tail = next;
+                ++count;
+            }
+        } catch (...) {
+            if (tail) { tail->right = nullptr; }
+            destroy_subtree(head);
+            destroy_subtree(a);
+            destroy_subtree(b);
+            nodes = 0;
+            rightmost = finger = nullptr;
+            throw;
+        }
+        adopt_vine(head, tail, count);
+    }
+
+    /*! appends the nodes of other, whose keys must all be greater than those of this tree, or all smaller,
+        and rebuilds the tree balanced: O(N + M), with a single comparison between the two trees.
+        If the key ranges overlap the trees are merged as merge(other). other is left empty */
+    void join(Tree && other) {
+        if (this == &other || other.empty()) { return; }
+        if (empty()) {
+            *this = std::move(other);
+            return;
+        }
+        Node * lowest = allLeft(root);
+        Node * other_lowest = allLeft(other.root);
+        const bool after = comp(rightmost->data.first, other_lowest->data.first);
+        if (!after && !comp(other.rightmost->data.first, lowest->data.first)) {
+            merge(std::move(other));
+            return;
+        }
+        const std::size_t count = nodes + other.nodes;
+        Node * vine = take_vine(other);         // may throw: this tree is linearized only after it
+        Node * vine_tail = allRight(vine);
+        treeToVine(root);
+        Node * tail = rightmost;
+        if (after) {
+            attachRight(tail, vine);
+            adopt_vine(root, vine_tail, count);
+        } else {
+            attachRight(vine_tail, root);
+            adopt_vine(vine, tail, count);
+        }
+    }
+
+    /*! splits the tree in two balanced trees: the keys smaller than key, and the others. The nodes are moved,
+        not copied, in O(N), leaving this tree empty; with an allocator releasing its memory at once,
+        as pool_allocator, the second tree gets its own, and its nodes are recreated moving the values */
+    std::pair<Tree, Tree> split(const K & key) {
+        std::pair<Tree, Tree> halves{Tree(comp), Tree(comp)};
+        halves.first.alloc = alloc;
+        if constexpr (movable_nodes) {
+            halves.second.alloc = alloc;
+        } else {
+            halves.second.alloc = node_traits::select_on_container_copy_construction(alloc);
+        }
+        treeToVine(root);
+        Node * head = root;
+        Node * last_lower = nullptr;
+        std::size_t lower = 0;
+        for (Node * node = head; node && comp(node->data.first, key); node = node->right) {
+            last_lower = node;
+            ++lower;
+        }
+        Node * upper_head = last_lower ? last_lower->right : head;
+        Node * upper_tail = rightmost;
+        const std::size_t upper = nodes - lower;
+        root = rightmost = finger = nullptr;
+        nodes = 0;
+        halves.first.adopt_vine(last_lower ? head : nullptr, last_lower, lower);
+
+        if constexpr (movable_nodes) {
+            halves.second.adopt_vine(upper_head, upper ? upper_tail : nullptr, upper);
+        } else {
+            root = upper_head;                 // owned here until recreated in the second tree
+            if (upper_head) { upper_head->parent = nullptr; }
+            rightmost = upper ? upper_tail : nullptr;
+            nodes = upper;
+            Node * vine = halves.second.take_vine(*this);
+            halves.second.adopt_vine(vine, vine ? allRight(vine) : nullptr, upper);
+            alloc = node_traits::select_on_container_copy_construction(alloc);    // the first tree owns the memory now
+        }
+        return halves;
     }
 
+    /*! immutable copy of the tree laid out for fast lookups, see FrozenTree */
+    FrozenTree<K, T, Compare> freeze() const {
+        return FrozenTree<K, T, Compare>(cbegin(), cend(), nodes, comp);
+    }
 
+    /*! writes the pairs, in order, to a binary snapshot at path (see snapshot.h), to be read back with load()
+        or mapped with MappedTree (mapped_tree.h). Keys and values must be trivially copyable or strings. False if the file
+        cannot be written */
+    bool save(const std::string & path) const {
+        return detail::writeSnapshot<K, T>(path, cbegin(), cend(), nodes);
+    }
 
-    /*!< tree balance function. calls arrayOfNodes() to linearize the tree, then creates a balanced tree*/
-    void balance()
+    /*! replaces the content of the tree with the snapshot at path, written by save() of a tree with the same
+        key and value types and comparator. The pairs are already sorted, so the tree is built balanced in O(N),
+        as from a sorted range; the file is read whole in memory first, and its checksum verified.
+        False, leaving the tree untouched, if the file is not a valid snapshot */
+    bool load(const std::string & path) {
+        std::vector<char> bytes;
+        detail::snapshot_records<K, T> records;
+        if (!detail::readFile(path, bytes) || !records.assign(bytes.data(), bytes.size(), true)) { return false; }
+        clear();
+        using decoder = typename detail::snapshot_records<K, T>::decoding_iterator;
+        build_sorted(decoder(&records, 0), decoder(&records, records.size()));
+        return true;
+    }
+
+    /*!< tree balance function. Relinks the existing nodes with the Day-Stout-Warren algorithm:
+         O(N) time, O(1) extra memory, no node or value is copied or allocated*/
+    void balance() noexcept
     {
-        this->height = 0;
-        std::vector<typename Node::data_type> vector(begin(), end()); //salviamo i nodi iterati in  un vector, in ordine di key
-        this->root = nullptr;  // cancelliamo tutti i nodi senza distruggere l'albero
-        this->recursive_balancer(vector); // ricreiamo l'albero dal vector
+        const auto started = this->start_balance();
+        const auto count = treeToVine(root);   // linearize the tree, in order of key
+        vineToTree(root, count);               // fold the list back into a complete tree
+        refresh_metadata();
+        finger = nullptr;                      // every node moved: hinted searches restart from the end
+        this->record_balance(started);
     };
+
+    /*! balance() using the threads of pool: the nodes are listed in order in a vector, walking separate
+        subtrees in parallel, then relinked in a tree of minimum height whose halves are linked in parallel,
+        down to parallel_cutoff nodes. O(N) work and O(N) extra memory, one pointer per node */
+    void balance(thread_pool & pool)
+    {
+        if (nodes < parallel_cutoff || pool.size() < 2) {
+            balance();
+            return;
+        }
+        const auto started = this->start_balance();
+        std::vector<Node *> sorted(nodes);
+        collect_in_order(pool, sorted.data());
+        root = link_sorted(pool, sorted.data(), sorted.data() + nodes, nullptr);
+        finger = nullptr;
+        this->record_balance(started);
+    }
+
+    /*! calls f on every pair, in parallel on the threads of pool, the tree being only read: f must be safe to call
+        from several threads at the same time, and gets the pairs in no particular order. The top levels of the
+        tree are split in about 8 subtrees per thread, walked in order by the tasks of pool; serial below
+        parallel_cutoff nodes. Nothing may change the tree meanwhile */
+    template <class F>
+    void parallel_for_each(thread_pool & pool, F f) const {
+        for_each_in(pool, nullptr, nullptr, f);
+    }
+
+    /*! parallel_for_each() on the pairs with keys in [first, last) */
+    template <class F>
+    void parallel_for_each(thread_pool & pool, const K & first, const K & last, F f) const {
+        for_each_in(pool, &first, &last, f);
+    }
+
+    /*! combines map(pair) of every pair, as std::transform_reduce: each subtree is reduced in parallel starting
+        from init, then the partial results are combined in order of key. combine must be associative, and init
+        its identity (0 for +), since it starts every partial result */
+    template <class R, class Combine, class Map>
+    R parallel_reduce(thread_pool & pool, R init, Combine combine, Map map) const {
+        return reduce_in(pool, nullptr, nullptr, std::move(init), combine, map);
+    }
+
+    /*! parallel_reduce() on the pairs with keys in [first, last) */
+    template <class R, class Combine, class Map>
+    R parallel_reduce(thread_pool & pool, const K & first, const K & last, R init, Combine combine, Map map) const {
+        return reduce_in(pool, &first, &last, std::move(init), combine, map);
+    }
+
+    /*! number of pairs satisfying pred, evaluated in parallel */
+    template <class Predicate>
+    std::size_t parallel_count_if(thread_pool & pool, Predicate pred) const {
+        return parallel_reduce(pool, std::size_t{0}, std::plus<std::size_t>(),
+                               [&pred](const typename Node::data_type & pair) -> std::size_t { return pred(pair) ? 1 : 0; });
+    }
+
+    /*! parallel_count_if() on the pairs with keys in [first, last) */
+    template <class Predicate>
+    std::size_t parallel_count_if(thread_pool & pool, const K & first, const K & last, Predicate pred) const {
+        return parallel_reduce(pool, first, last, std::size_t{0}, std::plus<std::size_t>(),
+                               [&pred](const typename Node::data_type & pair) -> std::size_t { return pred(pair) ? 1 : 0; });
+    }
+
+    /*! ordered mode, for side effects in order of key: map(pair) is computed in parallel, chunk by chunk, and
+        sink(pair, result) called on the calling thread, pair after pair, in order of key. The tree is split in
+        about 64 subtrees per thread; while the sink consumes the results of a window of pool.size() subtrees,
+        the threads compute the next one, so about 1/32 of the results are kept in memory */
+    template <class Map, class Sink>
+    void parallel_for_each_ordered(thread_pool & pool, Map map, Sink sink) const {
+        ordered_in(pool, nullptr, nullptr, map, sink);
+    }
+
+    /*! parallel_for_each_ordered() on the pairs with keys in [first, last) */
+    template <class Map, class Sink>
+    void parallel_for_each_ordered(thread_pool & pool, const K & first, const K & last, Map map, Sink sink) const {
+        ordered_in(pool, &first, &last, map, sink);
+    }
+
+    /*! snapshot of the instrumentation counters, see instrument::counting; with instrument::none only
+        the live nodes, their bytes and the height are filled. O(N) with balancing::none, to measure the height */
+    instrument::stats stats() const {
+        auto snapshot = this->counters();
+        snapshot.live_nodes = nodes;
+        snapshot.live_bytes = nodes * sizeof(Node);
+        snapshot.height = height();
+        return snapshot;
+    }
+
+    /*! zeroes the instrumentation counters, e.g. after balance(), to measure the lookups on the new shape */
+    void reset_stats() noexcept { this->reset_counters(); }
 };
 
 
 
-template<class K, class T>                                                       
-std::ostream& operator<<(std::ostream& ostream, const Tree<K,T>& tree) {
+template<class K, class T, class Compare, class Balance, class Alloc, class Instrument>
+std::ostream& operator<<(std::ostream& ostream, const Tree<K,T,Compare,Balance,Alloc,Instrument>& tree) {
 
     if (tree.empty()) {
         ostream << "Error: printing empty tree";
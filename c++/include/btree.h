@@ -0,0 +1,567 @@
+/**
+* @file btree.h
+*
+* @brief B+ tree with the same interface as Tree
+*
+*
+*/
+#pragma once
+
+#include <cstddef>   // size_t
+#include <cstdint>   // uint32_t
+#include <functional> // std::less
+#include <iomanip>   // cout alignment
+#include <iostream>  // std::ostream
+#include <iterator>  // forward_iterator_tag
+#include <type_traits>
+#include <utility>   // pair, move
+
+
+
+namespace detail {
+
+    /*! number of keys of a B+ tree node whose entries, a key and its value or child, take EntryBytes:
+        together with the node header they fill Lines cache lines, with at least 4 keys */
+    template <std::size_t EntryBytes, std::size_t HeaderBytes, std::size_t Lines = 4>
+    constexpr std::size_t btreeFanout() noexcept {
+        constexpr std::size_t keys = (Lines * 64 - HeaderBytes) / EntryBytes;
+        return keys < 4 ? 4 : keys;
+    }
+
+    /*! number of keys of a sorted array smaller than key. Linear scan without early exit, the compiler
+        turns it into branch free (often vectorized) code on arithmetic keys */
+    template <class K, class Key, class Compare>
+    std::size_t countLess(const K * keys, std::size_t count, const Key & key, const Compare & comp) noexcept {
+        std::size_t result = 0;
+        for (std::size_t i = 0; i < count; ++i) { result += comp(keys[i], key); }
+        return result;
+    }
+
+    /*! number of keys of a sorted array not greater than key */
+    template <class K, class Key, class Compare>
+    std::size_t countNotGreater(const K * keys, std::size_t count, const Key & key, const Compare & comp) noexcept {
+        std::size_t result = 0;
+        for (std::size_t i = 0; i < count; ++i) { result += !comp(key, keys[i]); }
+        return result;
+    }
+}
+
+
+/*! B+ tree, templated on key and values, with the same interface as Tree.
+    Nodes hold many keys: a node, with its header and its values or children, fills four cache lines,
+    so a lookup touches a few cache lines per level
+    instead of one per key. Pairs are only stored in the leaves, which are linked in a list for fast in order
+    iteration; internal nodes only hold separator keys. The tree is always balanced: all leaves have the same
+    depth and every node but the root is at least half full. Compare orders the keys as in Tree */
+template <class K, class T, class Compare = std::less<K>>
+class BTree {
+
+    struct internal_node;
+
+    /*! common header of leaves and internal nodes */
+    struct node_base {
+        internal_node * parent = nullptr;
+        std::uint32_t count = 0;             // number of keys
+        bool leaf;
+
+        explicit node_base(bool is_leaf) : leaf(is_leaf) {}
+    };
+
+    /*! a leaf holds the keys and values, and a link to the next leaf; an internal node one child more than keys */
+    static constexpr std::size_t leaf_capacity = detail::btreeFanout<sizeof(K) + sizeof(T), sizeof(node_base) + sizeof(void *)>();
+    static constexpr std::size_t internal_capacity = detail::btreeFanout<sizeof(K) + sizeof(node_base *), sizeof(node_base) + sizeof(node_base *)>();
+    static constexpr std::size_t leaf_minimum = leaf_capacity / 2;
+    static constexpr std::size_t internal_minimum = internal_capacity / 2;
+
+    struct alignas(64) leaf_node : node_base {
+        K keys[leaf_capacity];
+        T values[leaf_capacity];
+        leaf_node * next = nullptr;          // following leaf, in order of key
+
+        leaf_node() : node_base(true) {}
+    };
+
+    struct alignas(64) internal_node : node_base {
+        K keys[internal_capacity];                     // keys[i] is the smallest key below children[i + 1]
+        node_base * children[internal_capacity + 1];
+
+        internal_node() : node_base(false) {}
+    };
+
+    node_base * root = nullptr;
+    leaf_node * first = nullptr;             // leftmost leaf
+    std::size_t nodes = 0;                   // number of pairs
+    Compare comp;
+
+    static leaf_node * as_leaf(node_base * node) noexcept { return static_cast<leaf_node *>(node); }
+    static internal_node * as_internal(node_base * node) noexcept { return static_cast<internal_node *>(node); }
+
+    /*! leaf where key is, or should be inserted */
+    template <class Key>
+    leaf_node * find_leaf(const Key & key) const noexcept {
+        node_base * node = root;
+        while (!node->leaf) {
+            auto * internal = as_internal(node);
+            node = internal->children[detail::countNotGreater(internal->keys, internal->count, key, comp)];
+        }
+        return as_leaf(node);
+    }
+
+    /*! position of child among the children of its parent */
+    static std::size_t child_index(const node_base * child) noexcept {
+        const internal_node * parent = child->parent;
+        std::size_t i = 0;
+        while (parent->children[i] != child) { ++i; }
+        return i;
+    }
+
+    /*! adds key and right child at position index of an internal node with room for them */
+    static void internal_insert(internal_node * node, std::size_t index, const K & key, node_base * right) {
+        for (std::size_t i = node->count; i > index; --i) {
+            node->keys[i] = std::move(node->keys[i - 1]);
+            node->children[i + 1] = node->children[i];
+        }
+        node->keys[index] = key;
+        node->children[index + 1] = right;
+        right->parent = node;
+        ++node->count;
+    }
+
+    /*! removes key index and child index + 1 from an internal node */
+    static void internal_remove(internal_node * node, std::size_t index) {
+        for (std::size_t i = index; i + 1 < node->count; ++i) {
+            node->keys[i] = std::move(node->keys[i + 1]);
+            node->children[i + 1] = node->children[i + 2];
+        }
+        --node->count;
+    }
+
+    /*! links right, split from left, in the parent of left with separator key. Full parents are split in turn */
+    void insert_in_parent(node_base * left, K key, node_base * right) {
+        while (true) {
+            internal_node * parent = left->parent;
+            if (!parent) {                          // left was the root: the tree grows by one level
+                auto * fresh = new internal_node();
+                fresh->keys[0] = key;
+                fresh->children[0] = left;
+                fresh->children[1] = right;
+                fresh->count = 1;
+                left->parent = right->parent = fresh;
+                root = fresh;
+                return;
+            }
+            const std::size_t index = child_index(left);
+            if (parent->count < internal_capacity) {
+                internal_insert(parent, index, key, right);
+                return;
+            }
+
+            // parent is full: split it around the middle key, which moves one level up
+            K keys[internal_capacity + 1];
+            node_base * children[internal_capacity + 2];
+            for (std::size_t i = 0, j = 0; i <= internal_capacity; ++i) {
+                keys[i] = (i == index) ? key : std::move(parent->keys[j++]);
+            }
+            for (std::size_t i = 0, j = 0; i <= internal_capacity + 1; ++i) {
+                children[i] = (i == index + 1) ? right : parent->children[j++];
+            }
+            const std::size_t middle = (internal_capacity + 1) / 2;
+            auto * sibling = new internal_node();
+            parent->count = static_cast<std::uint32_t>(middle);
+            for (std::size_t i = 0; i < middle; ++i) { parent->keys[i] = std::move(keys[i]); }
+            for (std::size_t i = 0; i <= middle; ++i) {
+                parent->children[i] = children[i];
+                children[i]->parent = parent;
+            }
+            sibling->count = static_cast<std::uint32_t>(internal_capacity - middle);
+            for (std::size_t i = 0; i < sibling->count; ++i) { sibling->keys[i] = std::move(keys[middle + 1 + i]); }
+            for (std::size_t i = 0; i <= sibling->count; ++i) {
+                sibling->children[i] = children[middle + 1 + i];
+                sibling->children[i]->parent = sibling;
+            }
+            // the middle key moves up, linking the new sibling in the grandparent
+            left = parent;
+            right = sibling;
+            key = std::move(keys[middle]);
+        }
+    }
+
+    /*! restores the minimum occupancy of a leaf, borrowing from or merging with a sibling */
+    void fix_leaf(leaf_node * leaf) {
+        internal_node * parent = leaf->parent;
+        const std::size_t index = child_index(leaf);
+        auto * left = index > 0 ? as_leaf(parent->children[index - 1]) : nullptr;
+        auto * right = index < parent->count ? as_leaf(parent->children[index + 1]) : nullptr;
+
+        if (left && left->count > leaf_minimum) {                   // borrow the last pair of left
+            for (std::size_t i = leaf->count; i > 0; --i) {
+                leaf->keys[i] = std::move(leaf->keys[i - 1]);
+                leaf->values[i] = std::move(leaf->values[i - 1]);
+            }
+            --left->count;
+            leaf->keys[0] = std::move(left->keys[left->count]);
+            leaf->values[0] = std::move(left->values[left->count]);
+            ++leaf->count;
+            parent->keys[index - 1] = leaf->keys[0];
+        } else if (right && right->count > leaf_minimum) {          // borrow the first pair of right
+            leaf->keys[leaf->count] = std::move(right->keys[0]);
+            leaf->values[leaf->count] = std::move(right->values[0]);
+            ++leaf->count;
+            for (std::size_t i = 0; i + 1 < right->count; ++i) {
+                right->keys[i] = std::move(right->keys[i + 1]);
+                right->values[i] = std::move(right->values[i + 1]);
+            }
+            --right->count;
+            parent->keys[index] = right->keys[0];
+        } else {                                                    // merge with a sibling
+            if (!left) {                                            // merge right into leaf instead
+                left = leaf;
+                leaf = right;
+            }
+            for (std::size_t i = 0; i < leaf->count; ++i) {
+                left->keys[left->count + i] = std::move(leaf->keys[i]);
+                left->values[left->count + i] = std::move(leaf->values[i]);
+            }
+            left->count += leaf->count;
+            left->next = leaf->next;
+            internal_remove(parent, child_index(leaf) - 1);
+            delete leaf;
+            fix_internal(parent);
+        }
+    }
+
+    /*! restores the minimum occupancy of an internal node, rotating keys from or merging with a sibling */
+    void fix_internal(internal_node * node) {
+        while (true) {
+            internal_node * parent = node->parent;
+            if (!parent) {                                  // the root may shrink until it has a single child
+                if (node->count == 0) {
+                    root = node->children[0];
+                    root->parent = nullptr;
+                    delete node;
+                }
+                return;
+            }
+            if (node->count >= internal_minimum) { return; }
+
+            const std::size_t index = child_index(node);
+            auto * left = index > 0 ? as_internal(parent->children[index - 1]) : nullptr;
+            auto * right = index < parent->count ? as_internal(parent->children[index + 1]) : nullptr;
+
+            if (left && left->count > internal_minimum) {           // rotate the last child of left
+                for (std::size_t i = node->count; i > 0; --i) { node->keys[i] = std::move(node->keys[i - 1]); }
+                for (std::size_t i = node->count + 1; i > 0; --i) { node->children[i] = node->children[i - 1]; }
+                node->keys[0] = std::move(parent->keys[index - 1]);
+                node->children[0] = left->children[left->count];
+                node->children[0]->parent = node;
+                ++node->count;
+                parent->keys[index - 1] = std::move(left->keys[left->count - 1]);
+                --left->count;
+                return;
+            }
+            if (right && right->count > internal_minimum) {         // rotate the first child of right
+                node->keys[node->count] = std::move(parent->keys[index]);
+                node->children[node->count + 1] = right->children[0];
+                node->children[node->count + 1]->parent = node;
+                ++node->count;
+                parent->keys[index] = std::move(right->keys[0]);
+                for (std::size_t i = 0; i + 1 < right->count; ++i) { right->keys[i] = std::move(right->keys[i + 1]); }
+                for (std::size_t i = 0; i < right->count; ++i) { right->children[i] = right->children[i + 1]; }
+                --right->count;
+                return;
+            }
+            if (!left) {                                            // merge right into node instead
+                left = node;
+                node = right;
+            }
+            const std::size_t separator = child_index(node) - 1;
+            left->keys[left->count] = std::move(parent->keys[separator]);
+            for (std::size_t i = 0; i < node->count; ++i) { left->keys[left->count + 1 + i] = std::move(node->keys[i]); }
+            for (std::size_t i = 0; i <= node->count; ++i) {
+                left->children[left->count + 1 + i] = node->children[i];
+                node->children[i]->parent = left;
+            }
+            left->count += node->count + 1;
+            internal_remove(parent, separator);
+            delete node;
+            node = parent;
+        }
+    }
+
+    /*! frees a subtree. Recursion depth is the height of the tree, which is logarithmic */
+    static void destroy(node_base * node) noexcept {
+        if (!node->leaf) {
+            auto * internal = as_internal(node);
+            for (std::size_t i = 0; i <= internal->count; ++i) { destroy(internal->children[i]); }
+            delete internal;
+        } else {
+            delete as_leaf(node);
+        }
+    }
+
+    /*! deep copy of a subtree, relinking the copied leaves after last */
+    static node_base * clone(const node_base * node, internal_node * parent, leaf_node *& last) {
+        if (node->leaf) {
+            auto * copy = new leaf_node(*static_cast<const leaf_node *>(node));
+            copy->parent = parent;
+            copy->next = nullptr;
+            if (last) { last->next = copy; }
+            last = copy;
+            return copy;
+        }
+        const auto * internal = static_cast<const internal_node *>(node);
+        auto * copy = new internal_node();
+        copy->parent = parent;
+        copy->count = internal->count;
+        for (std::size_t i = 0; i < internal->count; ++i) { copy->keys[i] = internal->keys[i]; }
+        std::size_t built = 0;
+        try {
+            for (; built <= internal->count; ++built) {
+                copy->children[built] = clone(internal->children[built], copy, last);
+            }
+        } catch (...) {
+            for (std::size_t i = 0; i < built; ++i) { destroy(copy->children[i]); }
+            delete copy;
+            throw;
+        }
+        return copy;
+    }
+
+public:
+
+    /*! constructor */
+    BTree() = default;
+
+    /*! constructor with a given comparator */
+    explicit BTree(const Compare & compare) : comp(compare) {}
+
+    /*! Copy constructor */
+    BTree(const BTree & other) : nodes(other.nodes), comp(other.comp) {
+        if (other.root) {
+            leaf_node * last = nullptr;
+            root = clone(other.root, nullptr, last);
+            first = allLeft();
+        }
+    }
+
+    /*! Move constructor */
+    BTree(BTree && other) noexcept
+    : root(std::exchange(other.root, nullptr)),
+      first(std::exchange(other.first, nullptr)),
+      nodes(std::exchange(other.nodes, 0)),
+      comp(other.comp)
+    {}
+
+    /*! Copy and move assignment */
+    BTree & operator=(BTree other) noexcept {
+        std::swap(root, other.root);
+        std::swap(first, other.first);
+        std::swap(nodes, other.nodes);
+        std::swap(comp, other.comp);
+        return *this;
+    }
+
+    ~BTree() noexcept { clear(); }
+
+    /*! True if the tree holds no pair */
+    bool empty() const noexcept { return nodes == 0; }
+
+    /*! Returns the number of pairs */
+    std::size_t size() const noexcept { return nodes; }
+
+    /*! Returns the key comparison function object */
+    Compare key_comp() const { return comp; }
+
+    /*! Returns tree height, in nodes */
+    std::size_t height() const noexcept {
+        std::size_t levels = 0;
+        for (const node_base * node = root; node; node = node->leaf ? nullptr : static_cast<const internal_node *>(node)->children[0]) {
+            ++levels;
+        }
+        return levels;
+    }
+
+
+/////////////////////////////// ITERATOR TEMPLATE //////////////////////////////
+
+    template <bool Const>
+    class iterator_template {
+        using leaf_pointer = std::conditional_t<Const, const leaf_node *, leaf_node *>;
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const K, T>;
+        using difference_type = std::ptrdiff_t;
+        /*! keys and values are stored in separate arrays: dereferencing gives a pair of references */
+        using reference = std::pair<const K &, std::conditional_t<Const, const T &, T &>>;
+        struct pointer {
+            reference ref;
+            const reference * operator->() const noexcept { return &ref; }
+        };
+
+        iterator_template() = default;
+        iterator_template(leaf_pointer node, std::size_t position) : leaf(node), index(position) {}
+        /*! conversion from iterator to const_iterator */
+        template <bool WasConst, class = std::enable_if_t<Const && !WasConst>>
+        iterator_template(const iterator_template<WasConst> & other) : leaf(other.leaf), index(other.index) {}
+
+        reference operator*() const { return {leaf->keys[index], leaf->values[index]}; }
+        pointer operator->() const { return pointer{**this}; }
+        iterator_template & operator++() {
+            if (++index == leaf->count) {
+                leaf = leaf->next;
+                index = 0;
+            }
+            return *this;
+        }
+        iterator_template operator++(int) {
+            auto old = *this;
+            ++(*this);
+            return old;
+        }
+        friend bool operator== (const iterator_template & lhs, const iterator_template & rhs) {
+            return lhs.leaf == rhs.leaf && lhs.index == rhs.index;
+        }
+        friend bool operator!= (const iterator_template & lhs, const iterator_template & rhs) { return !(lhs == rhs); }
+
+    private:
+        friend class BTree;
+        template <bool> friend class iterator_template;
+        leaf_pointer leaf = nullptr;
+        std::size_t index = 0;
+    };
+
+    using iterator = iterator_template<false>;
+    using const_iterator = iterator_template<true>;
+
+    iterator       begin()        { return iterator(first, 0); }
+    const_iterator begin()  const { return const_iterator(first, 0); }
+    const_iterator cbegin() const { return const_iterator(first, 0); }
+
+    iterator       end()          { return iterator(nullptr, 0); }
+    const_iterator end()    const { return const_iterator(nullptr, 0); }
+    const_iterator cend()   const { return const_iterator(nullptr, 0); }
+
+    /*! add a pair, overwriting the value if the key is already present */
+    void insert(const K & key, const T & value) {
+        if (!root) {
+            first = new leaf_node();
+            root = first;
+        }
+        leaf_node * leaf = find_leaf(key);
+        std::size_t position = detail::countLess(leaf->keys, leaf->count, key, comp);
+        if (position < leaf->count && !comp(key, leaf->keys[position])) {
+            leaf->values[position] = value;
+            return;
+        }
+
+        if (leaf->count == leaf_capacity) {         // split the full leaf in two halves
+            auto * sibling = new leaf_node();
+            const std::size_t middle = leaf_capacity / 2;
+            for (std::size_t i = middle; i < leaf_capacity; ++i) {
+                sibling->keys[i - middle] = std::move(leaf->keys[i]);
+                sibling->values[i - middle] = std::move(leaf->values[i]);
+            }
+            sibling->count = static_cast<std::uint32_t>(leaf_capacity - middle);
+            leaf->count = static_cast<std::uint32_t>(middle);
+            sibling->next = leaf->next;
+            leaf->next = sibling;
+            insert_in_parent(leaf, sibling->keys[0], sibling);
+            if (position > middle) {
+                leaf = sibling;
+                position -= middle;
+            }
+        }
+        for (std::size_t i = leaf->count; i > position; --i) {
+            leaf->keys[i] = std::move(leaf->keys[i - 1]);
+            leaf->values[i] = std::move(leaf->values[i - 1]);
+        }
+        leaf->keys[position] = key;
+        leaf->values[position] = value;
+        ++leaf->count;
+        ++nodes;                                    // only once every allocation succeeded
+    }
+
+    /*! remove the pair pointed by it. Invalidates the iterators to the same leaf and to its siblings */
+    void erase(iterator it) {
+        leaf_node * leaf = it.leaf;
+        for (std::size_t i = it.index; i + 1 < leaf->count; ++i) {
+            leaf->keys[i] = std::move(leaf->keys[i + 1]);
+            leaf->values[i] = std::move(leaf->values[i + 1]);
+        }
+        --leaf->count;
+        --nodes;
+        if (leaf == root) {
+            if (leaf->count == 0) {
+                delete leaf;
+                root = first = nullptr;
+            }
+        } else if (leaf->count < leaf_minimum) {
+            fix_leaf(leaf);
+        }
+    }
+
+    /*! remove the pair with the given key, if any */
+    void erase(const K & k) {
+        auto it = find(k);
+        if (it != end()) { erase(it); }
+    }
+
+    /*! remove the pair with a key equivalent to k, only available with a transparent comparator */
+    template <class Key, class C = Compare, class = typename C::is_transparent>
+    void erase(const Key & k) {
+        auto it = find(k);
+        if (it != end()) { erase(it); }
+    }
+
+    /*! iterator to the pair with the given key, end() if missing */
+    iterator find(const K & k) const {
+        return locate(k);
+    }
+
+    /*! find with a key of any type comparable with K, only available with a transparent comparator */
+    template <class Key, class C = Compare, class = typename C::is_transparent>
+    iterator find(const Key & k) const {
+        return locate(k);
+    }
+
+    /*! tree deletion */
+    void clear() noexcept {
+        if (root) { destroy(root); }
+        root = first = nullptr;
+        nodes = 0;
+    }
+
+    /*! a B+ tree is always balanced: nothing to do, provided for compatibility with Tree */
+    void balance() noexcept {}
+
+private:
+    template <class Key>
+    iterator locate(const Key & k) const {
+        if (!root) { return iterator(nullptr, 0); }
+        leaf_node * leaf = find_leaf(k);
+        const std::size_t position = detail::countLess(leaf->keys, leaf->count, k, comp);
+        if (position == leaf->count || comp(k, leaf->keys[position])) { return iterator(nullptr, 0); }
+        return iterator(leaf, position);
+    }
+
+    leaf_node * allLeft() const noexcept {
+        node_base * node = root;
+        while (!node->leaf) { node = as_internal(node)->children[0]; }
+        return as_leaf(node);
+    }
+};
+
+
+
+template<class K, class T, class Compare>
+std::ostream& operator<<(std::ostream& ostream, const BTree<K,T,Compare>& tree) {
+
+    if (tree.empty()) {
+        ostream << "Error: printing empty tree";
+        return ostream;
+    }
+    for (auto t=tree.cbegin();t!=tree.cend();++t){
+        ostream << std::left << std::setw(12)<< t->first << ":" << t->second << "\n";
+    }
+  return ostream;
+}
@@ -0,0 +1,422 @@
+/**
+* @file compact_tree.h
+*
+* @brief Binary search tree stored in contiguous arrays, linked by 32 bit indices
+*
+*
+*/
+#pragma once
+
+#include <algorithm> // max
+#include <cstddef>   // size_t
+#include <cstdint>   // uint32_t
+#include <functional> // std::less
+#include <iomanip>   // cout alignment
+#include <iostream>  // std::ostream
+#include <iterator>  // bidirectional_iterator_tag
+#include <limits>
+#include <stdexcept> // length_error
+#include <type_traits>
+#include <utility>   // pair, move
+#include <vector>
+
+
+
+namespace detail {
+
+    /*! links of a compact node: indices in the arrays of the tree, compact_null if missing */
+    struct compact_links {
+        std::uint32_t left;
+        std::uint32_t right;
+    };
+
+    struct compact_parent_links {
+        std::uint32_t left;
+        std::uint32_t right;
+        std::uint32_t parent;
+    };
+
+    constexpr std::uint32_t compact_null = std::numeric_limits<std::uint32_t>::max();
+}
+
+
+/*! Binary search tree, templated on key and values, with the same interface as Tree, storing its nodes in three
+    parallel vectors instead of allocating them one by one: keys, values, and the links, which are 32 bit indices.
+    A Tree<uint64_t, uint32_t> node takes 40 bytes, 48 with the malloc header; here an entry takes 24 bytes,
+    20 with ParentLinks == false. Descents read the keys and links only, values are touched when found.
+    ParentLinks keeps the index of the parent of every node: iterators step in O(1) amortized. Without it
+    ++ and -- descend from the root to the next key, O(height). As in Tree with balancing::none, the shape
+    depends on the order of insertion until balance(), which also sorts the arrays by key, so that iterating
+    reads them sequentially.
+    At most 2^32 - 1 entries. erase() fills the hole with the last entry of the arrays, invalidating
+    the iterators to the erased entry and to the last one */
+template <class K, class T, class Compare = std::less<K>, bool ParentLinks = true>
+class CompactTree {
+
+    using index = std::uint32_t;
+    using links_type = std::conditional_t<ParentLinks, detail::compact_parent_links, detail::compact_links>;
+    static constexpr index null = detail::compact_null;
+
+    std::vector<K> keys;
+    std::vector<T> values;
+    std::vector<links_type> links;
+    index root = null;
+    Compare comp;
+
+    index & parent_slot(index node, index parent) noexcept {
+        return parent == null ? root : links[parent].left == node ? links[parent].left : links[parent].right;
+    }
+
+    void set_parent(index node, index parent) noexcept {
+        if constexpr (ParentLinks) {
+            if (node != null) { links[node].parent = parent; }
+        } else {
+            (void)node;
+            (void)parent;
+        }
+    }
+
+    index leftmost(index node) const noexcept {
+        while (links[node].left != null) { node = links[node].left; }
+        return node;
+    }
+
+    index rightmost(index node) const noexcept {
+        while (links[node].right != null) { node = links[node].right; }
+        return node;
+    }
+
+    /*! node with the smallest key greater than the one of node, null if none */
+    index successor(index node) const noexcept {
+        if (links[node].right != null) { return leftmost(links[node].right); }
+        if constexpr (ParentLinks) {
+            index parent = links[node].parent;
+            while (parent != null && node == links[parent].right) {
+                node = parent;
+                parent = links[node].parent;
+            }
+            return parent;
+        } else {
+            index result = null;
+            for (index current = root; current != node; ) {
+                if (comp(keys[node], keys[current])) {
+                    result = current;
+                    current = links[current].left;
+                } else {
+                    current = links[current].right;
+                }
+            }
+            return result;
+        }
+    }
+
+    /*! node with the greatest key smaller than the one of node, null if none */
+    index predecessor(index node) const noexcept {
+        if (links[node].left != null) { return rightmost(links[node].left); }
+        if constexpr (ParentLinks) {
+            index parent = links[node].parent;
+            while (parent != null && node == links[parent].left) {
+                node = parent;
+                parent = links[node].parent;
+            }
+            return parent;
+        } else {
+            index result = null;
+            for (index current = root; current != node; ) {
+                if (comp(keys[current], keys[node])) {
+                    result = current;
+                    current = links[current].right;
+                } else {
+                    current = links[current].left;
+                }
+            }
+            return result;
+        }
+    }
+
+    /*! node holding key, null if missing, and its parent (the last node visited if missing) */
+    template <class Key>
+    std::pair<index, index> locate(const Key & key) const {
+        index parent = null;
+        for (index node = root; node != null; ) {
+            if (comp(key, keys[node])) {
+                parent = node;
+                node = links[node].left;
+            } else if (comp(keys[node], key)) {
+                parent = node;
+                node = links[node].right;
+            } else {
+                return {node, parent};
+            }
+        }
+        return {null, parent};
+    }
+
+    /*! moves the last entry of the arrays to the free slot hole, fixing the links to it, and drops the last slot */
+    void fill_hole(index hole, index parent_of_last) {
+        const auto last = static_cast<index>(keys.size() - 1);
+        if (hole != last) {
+            parent_slot(last, parent_of_last) = hole;
+            keys[hole] = std::move(keys[last]);
+            values[hole] = std::move(values[last]);
+            links[hole] = links[last];
+            set_parent(links[hole].left, hole);
+            set_parent(links[hole].right, hole);
+        }
+        keys.pop_back();
+        values.pop_back();
+        links.pop_back();
+    }
+
+    /*! parent of node, which must be in the tree */
+    index parent_of(index node) const {
+        if constexpr (ParentLinks) {
+            return links[node].parent;
+        } else {
+            return locate(keys[node]).second;
+        }
+    }
+
+    /*! links the nodes with indices [first, last), sorted by key, in a tree of minimum height, and returns its root */
+    index link_sorted(index first, index last, index parent) noexcept {
+        if (first == last) { return null; }
+        const index middle = first + (last - first) / 2;
+        set_parent(middle, parent);
+        links[middle].left = link_sorted(first, middle, middle);
+        links[middle].right = link_sorted(middle + 1, last, middle);
+        return middle;
+    }
+
+public:
+
+    /*! empty tree */
+    CompactTree() = default;
+
+    /*! empty tree with a given comparator */
+    explicit CompactTree(const Compare & compare) : comp(compare) {}
+
+    bool empty() const noexcept { return root == null; }
+    std::size_t size() const noexcept { return keys.size(); }
+    Compare key_comp() const { return comp; }
+
+    /*! bytes taken by the arrays, allocated capacity included */
+    std::size_t memory() const noexcept {
+        return keys.capacity() * sizeof(K) + values.capacity() * sizeof(T) + links.capacity() * sizeof(links_type);
+    }
+
+    /*! room for count entries, without reallocations */
+    void reserve(std::size_t count) {
+        keys.reserve(count);
+        values.reserve(count);
+        links.reserve(count);
+    }
+
+    /*! Returns tree height: the number of nodes on the longest path from root to a leaf */
+    std::size_t height() const {
+        std::size_t result = 0;
+        std::vector<std::pair<index, std::size_t>> stack;
+        if (root != null) { stack.push_back({root, 1}); }
+        while (!stack.empty()) {
+            const auto [node, depth] = stack.back();
+            stack.pop_back();
+            result = std::max(result, depth);
+            if (links[node].left != null) { stack.push_back({links[node].left, depth + 1}); }
+            if (links[node].right != null) { stack.push_back({links[node].right, depth + 1}); }
+        }
+        return result;
+    }
+
+
+/////////////////////////////// ITERATOR TEMPLATE //////////////////////////////
+
+    template <bool Const>
+    class iterator_template {
+        using tree_pointer = std::conditional_t<Const, const CompactTree *, CompactTree *>;
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = std::pair<const K, T>;
+        using difference_type = std::ptrdiff_t;
+        /*! keys and values are stored in separate arrays: dereferencing gives a pair of references */
+        using reference = std::pair<const K &, std::conditional_t<Const, const T &, T &>>;
+        struct pointer {
+            reference ref;
+            const reference * operator->() const noexcept { return &ref; }
+        };
+
+        iterator_template() = default;
+        iterator_template(tree_pointer owner, index position) : tree(owner), node(position) {}
+        /*! conversion from iterator to const_iterator */
+        template <bool WasConst, class = std::enable_if_t<Const && !WasConst>>
+        iterator_template(const iterator_template<WasConst> & other) : tree(other.tree), node(other.node) {}
+
+        reference operator*() const { return {tree->keys[node], tree->values[node]}; }
+        pointer operator->() const { return pointer{**this}; }
+        iterator_template & operator++() {
+            node = tree->successor(node);
+            return *this;
+        }
+        iterator_template operator++(int) {
+            auto old = *this;
+            ++(*this);
+            return old;
+        }
+        /*! steps to the previous entry; from end() to the one with the highest key */
+        iterator_template & operator--() {
+            node = node == null ? tree->rightmost(tree->root) : tree->predecessor(node);
+            return *this;
+        }
+        iterator_template operator--(int) {
+            auto old = *this;
+            --(*this);
+            return old;
+        }
+        friend bool operator== (const iterator_template & lhs, const iterator_template & rhs) { return lhs.node == rhs.node; }
+        friend bool operator!= (const iterator_template & lhs, const iterator_template & rhs) { return !(lhs == rhs); }
+
+    private:
+        friend class CompactTree;
+        template <bool> friend class iterator_template;
+        tree_pointer tree = nullptr;
+        index node = null;
+    };
+
+    using iterator = iterator_template<false>;
+    using const_iterator = iterator_template<true>;
+
+    iterator       begin()        { return iterator(this, root == null ? null : leftmost(root)); }
+    const_iterator begin()  const { return const_iterator(this, root == null ? null : leftmost(root)); }
+    const_iterator cbegin() const { return begin(); }
+
+    iterator       end()          { return iterator(this, null); }
+    const_iterator end()    const { return const_iterator(this, null); }
+    const_iterator cend()   const { return end(); }
+
+    /*! add a pair, overwriting the value if the key is already present */
+    void insert(const K & key, const T & value) {
+        const auto found = locate(key);
+        if (found.first != null) {
+            values[found.first] = value;
+            return;
+        }
+        if (keys.size() >= null) { throw std::length_error("CompactTree holds at most 2^32 - 1 entries"); }
+        const auto node = static_cast<index>(keys.size());
+        keys.push_back(key);
+        try {
+            values.push_back(value);
+            links.push_back(links_type{});
+        } catch (...) {
+            if (values.size() > node) { values.pop_back(); }
+            keys.pop_back();
+            throw;
+        }
+        links[node].left = links[node].right = null;
+        set_parent(node, found.second);
+        if (found.second == null) {
+            root = node;
+        } else if (comp(key, keys[found.second])) {
+            links[found.second].left = node;
+        } else {
+            links[found.second].right = node;
+        }
+    }
+
+    /*! removes the entry it points to. The entry stored last in the arrays takes its slot */
+    void erase(iterator it) {
+        index node = it.node;
+        index parent = parent_of(node);
+        if (links[node].left != null && links[node].right != null) {   // take the pair of the successor, erase that
+            index next = links[node].right;
+            parent = node;
+            while (links[next].left != null) {
+                parent = next;
+                next = links[next].left;
+            }
+            keys[node] = std::move(keys[next]);
+            values[node] = std::move(values[next]);
+            node = next;
+        }
+        const index child = links[node].left != null ? links[node].left : links[node].right;
+        parent_slot(node, parent) = child;
+        set_parent(child, parent);
+
+        const auto last = static_cast<index>(keys.size() - 1);
+        fill_hole(node, node == last ? null : parent_of(last));
+    }
+
+    /*! remove the entry with the given key, if any */
+    void erase(const K & k) {
+        const index node = locate(k).first;
+        if (node != null) { erase(iterator(this, node)); }
+    }
+
+    /*! remove the entry with a key equivalent to k, only available with a transparent comparator */
+    template <class Key, class C = Compare, class = typename C::is_transparent>
+    void erase(const Key & k) {
+        const index node = locate(k).first;
+        if (node != null) { erase(iterator(this, node)); }
+    }
+
+    /*! iterator to the entry with the given key, end() if missing */
+    iterator find(const K & k) { return iterator(this, locate(k).first); }
+    const_iterator find(const K & k) const { return const_iterator(this, locate(k).first); }
+
+    /*! find with a key of any type comparable with K, only available with a transparent comparator */
+    template <class Key, class C = Compare, class = typename C::is_transparent>
+    iterator find(const Key & k) { return iterator(this, locate(k).first); }
+
+    template <class Key, class C = Compare, class = typename C::is_transparent>
+    const_iterator find(const Key & k) const { return const_iterator(this, locate(k).first); }
+
+    /*! removes every entry, keeping the capacity of the arrays */
+    void clear() noexcept {
+        keys.clear();
+        values.clear();
+        links.clear();
+        root = null;
+    }
+
+    /*! rebuilds the tree with minimum height, moving the entries so that the arrays are sorted by key:
+        O(N) time and O(N) extra memory while the arrays are rebuilt */
+    void balance() {
+        const std::size_t count = keys.size();
+        std::vector<index> order;
+        order.reserve(count);
+        std::vector<index> stack;
+        for (index node = root; node != null || !stack.empty(); ) {       // in order walk
+            if (node != null) {
+                stack.push_back(node);
+                node = links[node].left;
+            } else {
+                node = stack.back();
+                stack.pop_back();
+                order.push_back(node);
+                node = links[node].right;
+            }
+        }
+        std::vector<K> sorted_keys;
+        std::vector<T> sorted_values;
+        sorted_keys.reserve(count);
+        sorted_values.reserve(count);
+        for (index node : order) {
+            sorted_keys.push_back(std::move(keys[node]));
+            sorted_values.push_back(std::move(values[node]));
+        }
+        keys = std::move(sorted_keys);
+        values = std::move(sorted_values);
+        root = link_sorted(0, static_cast<index>(count), null);
+    }
+};
+
+
+template<class K, class T, class Compare, bool ParentLinks>
+std::ostream& operator<<(std::ostream& ostream, const CompactTree<K,T,Compare,ParentLinks>& tree) {
+
+    if (tree.empty()) {
+        ostream << "Error: printing empty tree";
+        return ostream;
+    }
+    for (auto t=tree.cbegin();t!=tree.cend();++t){
+        ostream << std::left << std::setw(12)<< t->first << ":" << t->second << "\n";
+    }
+  return ostream;
+}
@@ -0,0 +1,183 @@
+/**
+* @file concurrent_tree.h
+*
+* @brief Tree shared between threads, with readers that never block
+*
+*
+*/
+#pragma once
+
+#include <atomic>
+#include <cstddef>   // size_t
+#include <mutex>
+#include <thread>    // yield
+#include <utility>   // move, exchange
+#include <vector>
+
+#include "binary_tree.h"
+
+
+
+namespace detail {
+
+    /*! number of the calling thread, assigned on first use. Spreads readers over the slots of a read_indicator */
+    inline std::size_t threadTicket() noexcept {
+        static std::atomic<std::size_t> next{0};
+        thread_local const std::size_t ticket = next.fetch_add(1, std::memory_order_relaxed);
+        return ticket;
+    }
+
+    /*! counts the readers inside each of two versions. Every thread increments a counter of its own slot,
+        on its own cache line, so readers on different cores do not contend */
+    class read_indicator {
+
+        struct alignas(64) slot {
+            std::atomic<std::size_t> readers[2] = {{0}, {0}};
+        };
+
+        std::vector<slot> slots;
+
+    public:
+        explicit read_indicator(std::size_t count)
+        : slots(count ? count : 1)
+        {}
+
+        /*! the slot of the calling thread */
+        std::atomic<std::size_t> * arrive(unsigned version) noexcept {
+            auto * counter = &slots[threadTicket() % slots.size()].readers[version];
+            counter->fetch_add(1);
+            return counter;
+        }
+
+        static void depart(std::atomic<std::size_t> * counter) noexcept {
+            counter->fetch_sub(1);
+        }
+
+        /*! spins until no reader is inside version */
+        void wait_empty(unsigned version) const noexcept {
+            for (const auto & s : slots) {
+                while (s.readers[version].load() != 0) { std::this_thread::yield(); }
+            }
+        }
+    };
+}
+
+
+/*! Tree shared between threads, for read mostly workloads. Readers never block nor retry: they get a snapshot,
+    a const Tree that does not change while they hold it, and use the whole Tree interface on it (find,
+    iterators, lower_bound...). Writers are serialized by a mutex.
+
+    It follows the Left-Right technique: two copies of the tree are kept. A writer applies its change to the copy
+    nobody reads, publishes it with an atomic index, waits for the readers of the other copy to leave, and applies
+    the same change to that one. Readers announce themselves on per-thread counters, so lookups scale with the
+    number of cores; writes cost two tree updates plus the wait, and need twice the memory.
+    Snapshots should be short lived: a writer waits for the readers of the copy it is about to change.
+    Readers must not call find_near(), which moves the finger of the shared tree */
+template <class K, class T, class Compare = std::less<K>, class Balance = balancing::none,
+          class Alloc = std::allocator<std::pair<const K, T>>>
+class ConcurrentTree {
+public:
+    using tree_type = Tree<K, T, Compare, Balance, Alloc>;
+
+    /*! read access to the published tree, pinned until destruction */
+    class snapshot {
+    public:
+        snapshot(const snapshot &) = delete;
+        snapshot & operator=(const snapshot &) = delete;
+        snapshot(snapshot && other) noexcept
+        : tree(other.tree), counter(std::exchange(other.counter, nullptr))
+        {}
+        snapshot & operator=(snapshot &&) = delete;
+        ~snapshot() { if (counter) { detail::read_indicator::depart(counter); } }
+
+        const tree_type & operator*()  const noexcept { return *tree; }
+        const tree_type * operator->() const noexcept { return tree; }
+
+    private:
+        friend class ConcurrentTree;
+        snapshot(const tree_type * pinned, std::atomic<std::size_t> * slot) noexcept : tree(pinned), counter(slot) {}
+
+        const tree_type * tree;
+        std::atomic<std::size_t> * counter;
+    };
+
+    /*! empty tree; readers are spread over slots counters, one per hardware thread by default */
+    explicit ConcurrentTree(std::size_t slots = std::thread::hardware_concurrency())
+    : readers(slots)
+    {}
+
+    /*! starts from a copy of tree */
+    explicit ConcurrentTree(const tree_type & tree, std::size_t slots = std::thread::hardware_concurrency())
+    : instances{tree, tree},
+      readers(slots)
+    {}
+
+    ConcurrentTree(const ConcurrentTree &) = delete;
+    ConcurrentTree & operator=(const ConcurrentTree &) = delete;
+
+    /*! pins the current version of the tree. Wait free: never blocks, whatever the writers do */
+    snapshot read() const noexcept {
+        auto * counter = readers.arrive(version.load());
+        return snapshot(&instances[published.load()], counter);
+    }
+
+    /*! calls f on the current version of the tree and returns its result, which must not refer to the tree */
+    template <class Read>
+    decltype(auto) read(Read && f) const {
+        auto pinned = read();
+        return f(*pinned);
+    }
+
+    /*! applies change to the tree, as a function of tree_type &. It is called twice, once on each copy,
+        so it must be deterministic and not depend on the state of anything but the tree.
+        Several changes can be batched in one call, paying the wait for the readers only once.
+        If change throws, the copies are resynchronized and the exception is rethrown: the change is either
+        lost, or visible, if it already succeeded on the first copy */
+    template <class Change>
+    void update(Change && change) {
+        std::lock_guard<std::mutex> lock(writer);
+        const unsigned current = published.load();
+        try {
+            change(instances[1 - current]);         // nobody reads this copy
+        } catch (...) {
+            instances[1 - current] = instances[current];
+            throw;
+        }
+        published.store(1 - current);               // new readers go to the changed copy
+        const unsigned previous = version.load();
+        readers.wait_empty(1 - previous);           // readers of an earlier toggle, which may still use the old copy
+        version.store(1 - previous);
+        readers.wait_empty(previous);               // the old copy is now free
+        try {
+            change(instances[current]);
+        } catch (...) {                             // the change is already published: complete it with a copy
+            instances[current] = instances[1 - current];
+            throw;
+        }
+    }
+
+    /*! add a pair, overwriting the value if the key is already present */
+    void insert(const K & key, const T & value) {
+        update([&key, &value](tree_type & tree) { tree.insert(key, value); });
+    }
+
+    /*! remove the pair with the given key, if any */
+    void erase(const K & key) {
+        update([&key](tree_type & tree) { tree.erase(key); });
+    }
+
+    /*! Returns the number of pairs of the current version */
+    std::size_t size() const noexcept {
+        return read()->size();
+    }
+
+private:
+    /*! the two copies of the tree, equal but while update() runs */
+    tree_type instances[2];
+    /*! index of the copy new readers go to */
+    std::atomic<unsigned> published{0};
+    /*! counters new readers announce themselves on */
+    std::atomic<unsigned> version{0};
+    mutable detail::read_indicator readers;
+    std::mutex writer;
+};
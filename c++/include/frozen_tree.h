@@ -0,0 +1,213 @@
+/**
+* @file frozen_tree.h
+*
+* @brief Immutable, cache friendly snapshot of a Tree
+*
+*
+*/
+#pragma once
+
+#include <algorithm> // std::min
+#include <cstddef>   // size_t
+#include <functional> // std::less
+#include <iomanip>   // cout alignment
+#include <iostream>  // std::ostream
+#include <iterator>  // forward_iterator_tag
+#include <new>       // operator new with alignment
+#include <utility>   // pair
+#include <vector>
+
+
+
+namespace detail {
+
+    /*! allocator returning memory aligned to Alignment bytes, used to align arrays to cache lines */
+    template <class T, std::size_t Alignment>
+    struct aligned_allocator {
+        using value_type = T;
+        template <class U> struct rebind { using other = aligned_allocator<U, Alignment>; };
+
+        aligned_allocator() = default;
+        template <class U>
+        aligned_allocator(const aligned_allocator<U, Alignment> &) noexcept {}
+
+        T * allocate(std::size_t n) {
+            return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+        }
+        void deallocate(T * p, std::size_t) noexcept {
+            ::operator delete(p, std::align_val_t{Alignment});
+        }
+
+        friend bool operator==(const aligned_allocator &, const aligned_allocator &) noexcept { return true; }
+        friend bool operator!=(const aligned_allocator &, const aligned_allocator &) noexcept { return false; }
+    };
+
+    /*! hint to bring the cache line holding address in cache, no effect if the compiler has no builtin for it */
+    inline void prefetch(const void * address) noexcept {
+#if defined(__GNUC__)
+        __builtin_prefetch(address);
+#else
+        (void)address;
+#endif
+    }
+
+    /*! drops the trailing ones of k and the zero above them: the node reached by a branch free descent ending
+        at k, climbed back over its final right turns, is the lower bound of the key searched. Two shifts
+        where the compiler has a builtin counting the trailing ones, a loop otherwise; k must not be all ones */
+    constexpr std::size_t eytzingerUndoRightTurns(std::size_t k) noexcept {
+#if defined(__GNUC__)
+        return k >> __builtin_ctzll(static_cast<unsigned long long>(~k)) >> 1;   // a single shift of up to 64 bits is undefined
+#else
+        while (k & 1) { k >>= 1; }
+        return k >> 1;
+#endif
+    }
+
+    /*! position of the first node in order (the leftmost one) of an implicit tree with n nodes in BFS order,
+        where the children of node k are 2k and 2k+1. 0 if empty */
+    constexpr std::size_t eytzingerFirst(std::size_t n) noexcept {
+        if (n == 0) { return 0; }
+        std::size_t k = 1;
+        while (2 * k <= n) { k *= 2; }
+        return k;
+    }
+
+    /*! position following k in order in an implicit tree with n nodes in BFS order. 0 after the last one */
+    constexpr std::size_t eytzingerNext(std::size_t k, std::size_t n) noexcept {
+        if (2 * k + 1 <= n) {                   // leftmost node of the right subtree
+            k = 2 * k + 1;
+            while (2 * k <= n) { k *= 2; }
+            return k;
+        }
+        while (k & 1) { k >>= 1; }              // climb while k is a right child
+        return k >> 1;
+    }
+}
+
+
+/*! Read-only map built from a Tree with freeze(). Keys are stored contiguously in Eytzinger (BFS) order,
+    the layout of a complete binary search tree, in an array aligned to cache lines and separated
+    from the values: the first levels of the tree share a handful of cache lines, and find() descends
+    without branching on the comparison, prefetching the keys a few levels below.
+    Compare must order keys as the Tree they come from does */
+template <class K, class T, class Compare = std::less<K>>
+class FrozenTree {
+
+    static constexpr std::size_t cache_line = 64;
+
+    /*! levels skipped by the prefetch: the 2^prefetch_levels descendants of a node fill a cache line */
+    static constexpr unsigned prefetch_levels() noexcept {
+        unsigned levels = 0;
+        while ((std::size_t{2} << levels) * sizeof(K) <= cache_line) { ++levels; }
+        return levels;
+    }
+
+    /*! keys in BFS order, 1-based: keys[0] is padding, so that siblings share a cache line */
+    std::vector<K, detail::aligned_allocator<K, cache_line>> keys;
+    /*! values, in the same order as keys */
+    std::vector<T> values;
+    std::size_t count = 0;
+    Compare comp;
+
+    /*! 1-based BFS position of the pair with the given key, 0 if missing */
+    template <class Key>
+    std::size_t locate(const Key & key) const {
+        const auto * base = keys.data();
+        std::size_t k = 1;
+        while (k <= count) {
+            detail::prefetch(base + std::min(k << prefetch_levels(), count));
+            k = 2 * k + comp(base[k], key);         // branch free descent: right if the node key is smaller
+        }
+        k = detail::eytzingerUndoRightTurns(k);     // k is now the lower bound
+        if (k == 0 || comp(key, base[k])) { return 0; }
+        return k;
+    }
+
+public:
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const K, T>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const K &, const T &>;
+        /*! operator-> needs a pointer to the pair of references built on the fly */
+        struct pointer {
+            reference ref;
+            const reference * operator->() const noexcept { return &ref; }
+        };
+
+        const_iterator() = default;
+        const_iterator(const FrozenTree * owner, std::size_t position) : tree(owner), k(position) {}
+
+        reference operator*() const { return {tree->keys[k], tree->values[k]}; }
+        pointer operator->() const { return pointer{**this}; }
+        const_iterator & operator++() {
+            k = detail::eytzingerNext(k, tree->count);
+            return *this;
+        }
+        const_iterator operator++(int) {
+            auto old = *this;
+            ++(*this);
+            return old;
+        }
+        friend bool operator== (const const_iterator & lhs, const const_iterator & rhs) { return lhs.k == rhs.k; }
+        friend bool operator!= (const const_iterator & lhs, const const_iterator & rhs) { return !(lhs == rhs); }
+
+    private:
+        const FrozenTree * tree = nullptr;
+        std::size_t k = 0;                  // 1-based BFS position, 0 is end()
+    };
+
+    using iterator = const_iterator;
+
+    /*! empty map */
+    FrozenTree() = default;
+
+    /*! builds the map from n pairs, sorted by key without duplicates, as produced by Tree iterators */
+    template <class InputIt>
+    FrozenTree(InputIt first, InputIt last, std::size_t n, const Compare & compare = Compare())
+    : keys(n + 1), values(n + 1), count(n), comp(compare)
+    {
+        for (std::size_t k = detail::eytzingerFirst(count); first != last; ++first) {
+            keys[k] = first->first;
+            values[k] = first->second;
+            k = detail::eytzingerNext(k, count);
+        }
+    }
+
+    std::size_t size() const noexcept { return count; }
+    bool empty() const noexcept { return count == 0; }
+
+    /*! iterator to the pair with the given key, end() if missing */
+    const_iterator find(const K & key) const {
+        return const_iterator(this, locate(key));
+    }
+
+    /*! find with a key of any type comparable with K, only available with a transparent comparator */
+    template <class Key, class C = Compare, class = typename C::is_transparent>
+    const_iterator find(const Key & key) const {
+        return const_iterator(this, locate(key));
+    }
+
+    Compare key_comp() const { return comp; }
+
+    const_iterator begin()  const { return const_iterator(this, detail::eytzingerFirst(count)); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator end()    const { return const_iterator(this, 0); }
+    const_iterator cend()   const { return end(); }
+};
+
+
+template<class K, class T, class Compare>
+std::ostream& operator<<(std::ostream& ostream, const FrozenTree<K,T,Compare>& tree) {
+
+    if (tree.empty()) {
+        ostream << "Error: printing empty tree";
+        return ostream;
+    }
+    for (auto t=tree.cbegin();t!=tree.cend();++t){
+        ostream << std::left << std::setw(12)<< t->first << ":" << t->second << "\n";
+    }
+  return ostream;
+}
@@ -0,0 +1,136 @@
+/**
+* @file instrument.h
+*
+* @brief Instrumentation policies of Tree: counters of the work done by its operations
+*
+*
+*/
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>   // size_t
+#include <cstdint>   // uint64_t
+#include <iostream>  // std::ostream
+
+
+
+/*! namespace for the instrumentation policies, the last template parameter of Tree.
+    A policy is a base class of Tree, whose hooks are called on the hot paths:
+    instrument::none has empty hooks and no data, so it costs nothing */
+namespace instrument {
+
+    /*! operations whose descents are counted */
+    enum class operation { find, insert, erase };
+
+    /*! counters of one kind of operation */
+    struct operation_stats {
+        std::uint64_t calls = 0;
+        std::uint64_t comparisons = 0;      // calls of the comparator
+        std::uint64_t visited = 0;          // nodes visited on the way down
+    };
+
+    /*! snapshot of the counters of a tree, see Tree::stats() */
+    struct stats {
+        /*! lookups with a depth above this are counted in the last bucket of depths */
+        static constexpr std::size_t max_depth = 63;
+
+        operation_stats find, insert, erase;
+        /*! depths[d]: number of find whose descent visited d nodes */
+        std::array<std::uint64_t, max_depth + 1> depths{};
+        std::size_t live_nodes = 0;
+        std::size_t live_bytes = 0;         // memory of the nodes, without allocator overhead
+        std::size_t height = 0;
+        std::uint64_t balance_calls = 0;
+        std::chrono::nanoseconds balance_time{0};
+
+        operation_stats & of(operation op) noexcept {
+            return op == operation::find ? find : op == operation::insert ? insert : erase;
+        }
+
+        /*! writes the snapshot as a single JSON object */
+        void write_json(std::ostream & out) const {
+            auto write = [&out](const char * name, const operation_stats & op) {
+                out << "\"" << name << "\":{\"calls\":" << op.calls << ",\"comparisons\":" << op.comparisons
+                    << ",\"visited\":" << op.visited << "},";
+            };
+            out << "{";
+            write("find", find);
+            write("insert", insert);
+            write("erase", erase);
+            out << "\"depths\":[";
+            std::size_t last = depths.size();
+            while (last > 0 && depths[last - 1] == 0) { --last; }
+            for (std::size_t d = 0; d < last; ++d) { out << (d ? "," : "") << depths[d]; }
+            out << "],\"live_nodes\":" << live_nodes << ",\"live_bytes\":" << live_bytes << ",\"height\":" << height
+                << ",\"balance_calls\":" << balance_calls << ",\"balance_ns\":" << balance_time.count() << "}";
+        }
+
+        /*! human readable dump: averages per operation and the non empty buckets of depths */
+        friend std::ostream & operator<<(std::ostream & out, const stats & s) {
+            auto write = [&out](const char * name, const operation_stats & op) {
+                out << name << ": " << op.calls << " calls";
+                if (op.calls) {
+                    out << ", " << static_cast<double>(op.comparisons) / static_cast<double>(op.calls) << " comparisons and "
+                        << static_cast<double>(op.visited) / static_cast<double>(op.calls) << " nodes visited each";
+                }
+                out << "\n";
+            };
+            write("find", s.find);
+            write("insert", s.insert);
+            write("erase", s.erase);
+            out << "find depths:";
+            for (std::size_t d = 0; d < s.depths.size(); ++d) {
+                if (s.depths[d]) { out << " " << d << (d == max_depth ? "+" : "") << ":" << s.depths[d]; }
+            }
+            out << "\nlive nodes: " << s.live_nodes << " (" << s.live_bytes << " bytes), height " << s.height << "\n"
+                << "balance: " << s.balance_calls << " calls, " << s.balance_time.count() << " ns\n";
+            return out;
+        }
+    };
+
+    /*! no instrumentation: every hook is empty and inlined away */
+    struct none {
+        static constexpr bool enabled = false;
+
+        /*! value returned by start_balance and passed back to record_balance */
+        struct timer {};
+
+        void record_descent(operation, std::size_t, std::size_t) const noexcept {}
+        timer start_balance() const noexcept { return {}; }
+        void record_balance(timer) const noexcept {}
+        stats counters() const noexcept { return {}; }
+        void reset_counters() noexcept {}
+    };
+
+    /*! counts the comparisons and nodes visited by find, insert and erase, the depths of the lookups and the
+        calls and time of balance(). The counters are plain integers, updated also by const lookups: a tree
+        read by several threads at once, as the one inside ConcurrentTree, must use instrument::none */
+    struct counting {
+        static constexpr bool enabled = true;
+
+        using timer = std::chrono::steady_clock::time_point;
+
+        /*! a descent visiting visited nodes with comparisons calls of the comparator */
+        void record_descent(operation op, std::size_t visited, std::size_t comparisons) const noexcept {
+            auto & counter = totals.of(op);
+            ++counter.calls;
+            counter.comparisons += comparisons;
+            counter.visited += visited;
+            if (op == operation::find) { ++totals.depths[visited < stats::max_depth ? visited : stats::max_depth]; }
+        }
+
+        timer start_balance() const noexcept { return std::chrono::steady_clock::now(); }
+
+        void record_balance(timer start) const noexcept {
+            ++totals.balance_calls;
+            totals.balance_time += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        }
+
+        stats counters() const noexcept { return totals; }
+        void reset_counters() noexcept { totals = stats(); }
+
+    private:
+        mutable stats totals;
+    };
+}
@@ -0,0 +1,74 @@
+/**
+* @file key_prefix.h
+*
+* @brief Inline key prefixes, resolving most key comparisons of a descent without touching the keys
+*
+*
+*/
+#pragma once
+
+#include <algorithm> // std::min
+#include <cstdint>   // uint64_t
+#include <cstring>   // memcpy
+#include <functional> // std::less
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+
+
+/*! key traits hook: when enabled, every node keeps of(key), an integer ordered as the keys, next to its links.
+    A descent compares the integers, and reads the key only when they are equal and the prefix is not decisive.
+    Specializations must provide:
+        view_type                   what lookup keys are converted to
+        of(view_type)               the prefix: of(a) < of(b) must imply a < b for Compare
+        decisive(prefix)            true if equal prefixes imply equal keys
+        compare(view_type, view_type) three way comparison, consistent with Compare
+    Disabled by default */
+template <class K, class Compare, class = void>
+struct key_prefix {
+    static constexpr bool enabled = false;
+};
+
+/*! std::string keys ordered by std::less: the first 7 bytes, big endian, followed by the length capped at 8.
+    Keys shorter than 8 bytes fit whole in the prefix; the others are compared in full on a tie */
+template <class Compare>
+struct key_prefix<std::string, Compare, std::enable_if_t<std::is_same<Compare, std::less<std::string>>::value
+                                                      || std::is_same<Compare, std::less<>>::value>> {
+    static constexpr bool enabled = true;
+    using view_type = std::string_view;
+
+    static std::uint64_t of(std::string_view key) noexcept {
+        unsigned char bytes[7] = {};
+        if (!key.empty()) {                     // data() may be null for an empty view
+            std::memcpy(bytes, key.data(), std::min<std::size_t>(key.size(), sizeof(bytes)));
+        }
+        std::uint64_t prefix = 0;
+        for (unsigned char byte : bytes) { prefix = (prefix << 8) | byte; }     // chars compare as unsigned
+        return (prefix << 8) | std::min<std::size_t>(key.size(), 8);
+    }
+
+    static bool decisive(std::uint64_t prefix) noexcept { return (prefix & 0xff) < 8; }
+
+    static int compare(std::string_view lhs, std::string_view rhs) noexcept { return lhs.compare(rhs); }
+};
+
+
+namespace detail {
+
+    /*! room for the prefix of the key in a node, nothing if the key traits are disabled */
+    template <bool Enabled>
+    struct prefix_storage {};
+
+    template <>
+    struct prefix_storage<true> { std::uint64_t prefix = 0; };
+
+    /*! true if the prefix of Traits applies to lookups of type Key */
+    template <class Traits, class Key, class = void>
+    struct uses_prefix : std::false_type {};
+
+    template <class Traits, class Key>
+    struct uses_prefix<Traits, Key, std::enable_if_t<Traits::enabled
+                                                     && std::is_convertible<const Key &, typename Traits::view_type>::value>>
+        : std::true_type {};
+}
@@ -0,0 +1,200 @@
+/**
+* @file mapped_tree.h
+*
+* @brief MappedTree, a read-only map served from a memory mapped snapshot. Needs a POSIX system
+*
+*
+*/
+#pragma once
+
+#include <cstddef>   // size_t
+#include <functional> // std::less
+#include <iterator>  // iterator tags
+#include <string>
+#include <utility>   // pair, exchange
+
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close
+
+#include "snapshot.h"
+
+
+
+/*! Read-only map served from a snapshot written by Tree::save, mapped in memory: opening it only maps the file,
+    find() binary searches the records in place and iterators read the pairs from the mapped pages, which the
+    system loads on first access. Keys and values are read as snapshot views: copies of trivially copyable
+    types, std::string_view for strings. Compare must order the views as the comparator of the saved Tree
+    orders its keys: the default std::less<> does it for std::less<K> */
+template <class K, class T, class Compare = std::less<>>
+class MappedTree {
+
+    using records_type = detail::snapshot_records<K, T>;
+
+    const char * mapping = nullptr;
+    std::size_t length = 0;
+    records_type records;
+    Compare comp;
+
+    /*! first position whose key is not smaller than key (Strict == false) or greater than key (Strict == true) */
+    template <bool Strict, class Key>
+    std::size_t bound(const Key & key) const {
+        std::size_t first = 0, n = records.size();
+        while (n > 0) {
+            const std::size_t half = n / 2;
+            const auto probe = key_at(first + half);
+            if (Strict ? !comp(key, probe) : comp(probe, key)) {
+                first += half + 1;
+                n -= half + 1;
+            } else {
+                n = half;
+            }
+        }
+        return first;
+    }
+
+public:
+
+    using key_view = typename records_type::key_view;
+    using value_view = typename records_type::value_view;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::pair<key_view, value_view>;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type;
+        /*! operator-> needs a pointer to the pair built on the fly */
+        struct pointer {
+            value_type pair;
+            const value_type * operator->() const noexcept { return &pair; }
+        };
+
+        const_iterator() = default;
+        const_iterator(const MappedTree * owner, std::size_t position) : tree(owner), i(position) {}
+
+        reference operator*() const { return {tree->key_at(i), tree->value_at(i)}; }
+        pointer operator->() const { return pointer{**this}; }
+        const_iterator & operator++() { ++i; return *this; }
+        const_iterator operator++(int) { auto old = *this; ++i; return old; }
+        const_iterator & operator--() { --i; return *this; }
+        const_iterator operator--(int) { auto old = *this; --i; return old; }
+        const_iterator & operator+=(difference_type n) { i = static_cast<std::size_t>(static_cast<difference_type>(i) + n); return *this; }
+        const_iterator operator+(difference_type n) const { auto result = *this; return result += n; }
+        const_iterator & operator-=(difference_type n) { return *this += -n; }
+        const_iterator operator-(difference_type n) const { auto result = *this; return result += -n; }
+        difference_type operator-(const const_iterator & other) const {
+            return static_cast<difference_type>(i) - static_cast<difference_type>(other.i);
+        }
+        reference operator[](difference_type n) const { return *(*this + n); }
+        friend bool operator== (const const_iterator & lhs, const const_iterator & rhs) { return lhs.i == rhs.i; }
+        friend bool operator!= (const const_iterator & lhs, const const_iterator & rhs) { return lhs.i != rhs.i; }
+        friend bool operator< (const const_iterator & lhs, const const_iterator & rhs) { return lhs.i < rhs.i; }
+        friend bool operator> (const const_iterator & lhs, const const_iterator & rhs) { return lhs.i > rhs.i; }
+        friend bool operator<= (const const_iterator & lhs, const const_iterator & rhs) { return lhs.i <= rhs.i; }
+        friend bool operator>= (const const_iterator & lhs, const const_iterator & rhs) { return lhs.i >= rhs.i; }
+
+    private:
+        const MappedTree * tree = nullptr;
+        std::size_t i = 0;
+    };
+
+    using iterator = const_iterator;
+
+    /*! closed map, empty */
+    MappedTree() = default;
+
+    /*! maps the snapshot at path, see open(). Check is_open() */
+    explicit MappedTree(const std::string & path, bool verify = false, const Compare & compare = Compare())
+    : comp(compare)
+    {
+        open(path, verify);
+    }
+
+    MappedTree(const MappedTree &) = delete;
+    MappedTree & operator=(const MappedTree &) = delete;
+
+    MappedTree(MappedTree && other) noexcept
+    : mapping(std::exchange(other.mapping, nullptr)),
+      length(std::exchange(other.length, 0)),
+      records(std::exchange(other.records, records_type())),
+      comp(other.comp)
+    {}
+
+    MappedTree & operator=(MappedTree && other) noexcept {
+        if (this != &other) {
+            close();
+            mapping = std::exchange(other.mapping, nullptr);
+            length = std::exchange(other.length, 0);
+            records = std::exchange(other.records, records_type());
+            comp = other.comp;
+        }
+        return *this;
+    }
+
+    ~MappedTree() { close(); }
+
+    /*! maps the snapshot at path, read only. With verify the checksum of the whole payload is checked, reading
+        the file once; otherwise only the header is, and every record is bounds checked when it is read.
+        False, leaving the map closed, if the file cannot be mapped, is not a snapshot of keys and values
+        of these types, or is corrupted */
+    bool open(const std::string & path, bool verify = false) {
+        close();
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) { return false; }
+        struct stat info;
+        void * address = MAP_FAILED;
+        if (::fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) >= sizeof(detail::snapshot_header)) {
+            address = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);                        // the mapping stays valid
+        if (address == MAP_FAILED) { return false; }
+        mapping = static_cast<const char *>(address);
+        length = static_cast<std::size_t>(info.st_size);
+
+        if (!records.assign(mapping, length, verify)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    /*! unmaps the snapshot; iterators and views become invalid */
+    void close() noexcept {
+        if (mapping) { ::munmap(const_cast<char *>(mapping), length); }
+        mapping = nullptr;
+        length = 0;
+        records = records_type();
+    }
+
+    bool is_open() const noexcept { return mapping != nullptr; }
+    std::size_t size() const noexcept { return records.size(); }
+    bool empty() const noexcept { return records.size() == 0; }
+    Compare key_comp() const { return comp; }
+
+    /*! key and value of the i-th pair in order, read in place. Throw std::runtime_error if the record
+        is corrupted, reaching out of the file */
+    key_view key_at(std::size_t i) const { return records.key_at(i); }
+    value_view value_at(std::size_t i) const { return records.value_at(i); }
+
+    const_iterator begin()  const { return const_iterator(this, 0); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator end()    const { return const_iterator(this, size()); }
+    const_iterator cend()   const { return end(); }
+
+    /*! iterator to the pair with a key equivalent to key, end() if missing. O(log N) */
+    template <class Key>
+    const_iterator find(const Key & key) const {
+        const std::size_t i = bound<false>(key);
+        return const_iterator(this, i < size() && !comp(key, key_at(i)) ? i : size());
+    }
+
+    /*! first pair whose key is not smaller than key, and first whose key is greater than key: [lower, upper)
+        walks the keys in a range */
+    template <class Key>
+    const_iterator lower_bound(const Key & key) const { return const_iterator(this, bound<false>(key)); }
+
+    template <class Key>
+    const_iterator upper_bound(const Key & key) const { return const_iterator(this, bound<true>(key)); }
+};
@@ -0,0 +1,168 @@
+/**
+* @file pool_allocator.h
+*
+* @brief Slab allocator for tree nodes
+*
+*
+*/
+#pragma once
+
+#include <algorithm> // std::max
+#include <cstddef>   // size_t, max_align_t
+#include <memory>    // std::shared_ptr
+#include <new>       // operator new
+#include <utility>   // std::exchange
+
+
+
+namespace detail {
+
+    /*! hands out fixed-size blocks carved from large slabs. Freed blocks are kept in a free list and recycled,
+        release() gives back every slab at once */
+    class slab_arena {
+
+        /*! header placed at the beginning of every slab, links the slabs together */
+        struct alignas(std::max_align_t) slab { slab * next; };
+
+        /*! a freed block, reused to store the free list link */
+        struct free_block { free_block * next; };
+
+        std::size_t slab_bytes;
+        std::size_t block_size = 0;        // set by the first allocation
+        slab * slabs = nullptr;
+        free_block * free_list = nullptr;
+        char * cursor = nullptr;           // next never used block of the current slab
+        char * slab_end = nullptr;
+
+        /*! allocates a new slab with room for at least count blocks and makes it the current one */
+        void grow(std::size_t count) {
+            const std::size_t bytes = std::max(slab_bytes, sizeof(slab) + count * block_size);
+            auto * fresh = static_cast<slab *>(::operator new(bytes));
+            fresh->next = slabs;
+            slabs = fresh;
+            cursor = reinterpret_cast<char *>(fresh) + sizeof(slab);
+            slab_end = reinterpret_cast<char *>(fresh) + bytes;
+        }
+
+    public:
+        explicit slab_arena(std::size_t bytes) noexcept : slab_bytes(bytes) {}
+
+        slab_arena(const slab_arena &) = delete;
+        slab_arena & operator=(const slab_arena &) = delete;
+
+        ~slab_arena() { release(); }
+
+        /*! true if blocks of the given size and alignment can be served by this arena */
+        bool fits(std::size_t size, std::size_t alignment) noexcept {
+            if (alignment > alignof(std::max_align_t)) { return false; }
+            if (block_size == 0) {          // first use fixes the block size
+                const std::size_t unit = std::max(alignment, sizeof(free_block));
+                block_size = (std::max(size, sizeof(free_block)) + unit - 1) / unit * unit;
+            }
+            return size <= block_size;
+        }
+
+        void * allocate() {
+            if (free_list) {
+                return std::exchange(free_list, free_list->next);
+            }
+            if (static_cast<std::size_t>(slab_end - cursor) < block_size) { grow(1); }
+            return std::exchange(cursor, cursor + block_size);
+        }
+
+        void deallocate(void * block) noexcept {
+            free_list = ::new (block) free_block{free_list};
+        }
+
+        /*! makes sure the next count allocations are served by a single, already allocated, slab */
+        void reserve(std::size_t count) {
+            if (block_size != 0 && static_cast<std::size_t>(slab_end - cursor) < count * block_size) { grow(count); }
+        }
+
+        /*! frees every slab: all the blocks handed out so far become invalid */
+        void release() noexcept {
+            while (slabs) {
+                ::operator delete(std::exchange(slabs, slabs->next));
+            }
+            free_list = nullptr;
+            cursor = slab_end = nullptr;
+        }
+    };
+}
+
+
+/*! Allocator serving single objects from a slab_arena. Copies share the same arena, as the standard requires;
+    a copied container gets a new one. Intended for node based containers like Tree: nodes freed by erase are
+    recycled, and clear() releases all the slabs in one go instead of freeing nodes one by one */
+template <class T, std::size_t SlabBytes = 64 * 1024>
+class pool_allocator {
+
+    template <class U, std::size_t B> friend class pool_allocator;
+
+    std::shared_ptr<detail::slab_arena> arena = std::make_shared<detail::slab_arena>(SlabBytes);
+
+    detail::slab_arena & get_arena() {
+        if (!arena) { arena = std::make_shared<detail::slab_arena>(SlabBytes); }  // moved-from allocator
+        return *arena;
+    }
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    template <class U>
+    struct rebind { using other = pool_allocator<U, SlabBytes>; };
+
+    pool_allocator() = default;
+
+    template <class U>
+    pool_allocator(const pool_allocator<U, SlabBytes> & other) noexcept : arena(other.arena) {}
+
+    T * allocate(std::size_t n) {
+        if (n == 1 && get_arena().fits(sizeof(T), alignof(T))) {
+            return static_cast<T *>(arena->allocate());
+        }
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T * p, std::size_t n) noexcept {
+        if (n == 1 && arena && arena->fits(sizeof(T), alignof(T))) {
+            arena->deallocate(p);
+        } else {
+            ::operator delete(p);
+        }
+    }
+
+    /*! copied containers do not share the pool of the original */
+    pool_allocator select_on_container_copy_construction() const { return pool_allocator(); }
+
+    /*! preallocates room for count objects in one slab */
+    void reserve(std::size_t count) {
+        if (get_arena().fits(sizeof(T), alignof(T))) { arena->reserve(count); }
+    }
+
+    /*! true if no other allocator shares the pool, so that release() frees only objects allocated through
+        this one. Copies made by hand, or converted from another allocator, share it */
+    bool sole_owner() const noexcept {
+        return !arena || arena.use_count() == 1;
+    }
+
+    /*! frees every object allocated so far at once, if the pool is not shared (see sole_owner()); false,
+        freeing nothing, otherwise. Destructors are not called */
+    bool release() noexcept {
+        if (!sole_owner()) { return false; }
+        if (arena) { arena->release(); }
+        return true;
+    }
+
+    friend bool operator==(const pool_allocator & lhs, const pool_allocator & rhs) noexcept {
+        return lhs.arena == rhs.arena;
+    }
+
+    friend bool operator!=(const pool_allocator & lhs, const pool_allocator & rhs) noexcept {
+        return !(lhs == rhs);
+    }
+};
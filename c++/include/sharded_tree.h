@@ -0,0 +1,143 @@
+/**
+* @file sharded_tree.h
+*
+* @brief Map split in independently locked Trees, for write heavy multithreaded workloads
+*
+*
+*/
+#pragma once
+
+#include <cstddef>   // size_t
+#include <cstdint>   // uint64_t
+#include <functional> // std::hash, std::less
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <utility>   // pair
+#include <vector>
+
+#include "binary_tree.h"
+
+
+
+/*! Map whose keys are spread by hash over N Trees, the shards, each guarded by its own reader-writer lock.
+    Threads working on different shards never wait for each other, so inserts and erases scale with the
+    number of threads as long as N is well above it. Every shard lies on its own cache lines, so locking
+    one does not slow down the cores using its neighbours.
+
+    Lookups return a copy of the value, since the shard is unlocked before returning. Iteration in order of
+    key merges the N shards, all locked for reading meanwhile */
+template <class K, class T, std::size_t N = 64, class Compare = std::less<K>, class Balance = balancing::none,
+          class Alloc = std::allocator<std::pair<const K, T>>, class Hash = std::hash<K>>
+class ShardedTree {
+public:
+    using tree_type = Tree<K, T, Compare, Balance, Alloc>;
+
+private:
+    static_assert(N > 0, "ShardedTree needs at least one shard");
+
+    struct alignas(64) shard {
+        mutable std::shared_mutex lock;
+        tree_type tree;
+    };
+
+    shard shards[N];
+    Hash hasher;
+    Compare comp;
+
+    /*! position of the shard of key. The hash is mixed with a multiplication, since std::hash of integers
+        is the identity */
+    std::size_t shard_index(const K & key) const noexcept {
+        const std::uint64_t mixed = static_cast<std::uint64_t>(hasher(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>((mixed >> 32) % N);
+    }
+
+public:
+
+    /*! constructor */
+    ShardedTree() = default;
+
+    ShardedTree(const ShardedTree &) = delete;
+    ShardedTree & operator=(const ShardedTree &) = delete;
+
+    /*! add a pair, overwriting the value if the key is already present */
+    void insert(const K & key, const T & value) {
+        auto & s = shards[shard_index(key)];
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+        s.tree.insert(key, value);
+    }
+
+    /*! remove the pair with the given key, if any */
+    void erase(const K & key) {
+        auto & s = shards[shard_index(key)];
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+        s.tree.erase(key);
+    }
+
+    /*! copy of the value of key, nothing if missing */
+    std::optional<T> find(const K & key) const {
+        auto & s = shards[shard_index(key)];
+        std::shared_lock<std::shared_mutex> guard(s.lock);
+        auto it = s.tree.find(key);
+        if (it == s.tree.end()) { return std::nullopt; }
+        return it->second;
+    }
+
+    /*! True if key is present */
+    bool contains(const K & key) const {
+        auto & s = shards[shard_index(key)];
+        std::shared_lock<std::shared_mutex> guard(s.lock);
+        return s.tree.find(key) != s.tree.end();
+    }
+
+    /*! Returns the number of pairs. Shards are counted one at a time: with concurrent writers
+        the result is not a snapshot */
+    std::size_t size() const {
+        std::size_t total = 0;
+        for (const auto & s : shards) {
+            std::shared_lock<std::shared_mutex> guard(s.lock);
+            total += s.tree.size();
+        }
+        return total;
+    }
+
+    /*! True if no shard holds a pair */
+    bool empty() const { return size() == 0; }
+
+    /*! removes every pair, one shard at a time */
+    void clear() {
+        for (auto & s : shards) {
+            std::unique_lock<std::shared_mutex> guard(s.lock);
+            s.tree.clear();
+        }
+    }
+
+    /*! calls visit(key, value) on every pair in order of key, merging the shards. All of them stay locked
+        for reading meanwhile, so the visit sees a consistent state; visit must not modify this map.
+        Every step picks the smallest key among the N shard iterators: O(N) per pair */
+    template <class Visit>
+    void for_each(Visit && visit) const {
+        std::vector<std::shared_lock<std::shared_mutex>> guards;
+        guards.reserve(N);
+        for (const auto & s : shards) { guards.emplace_back(s.lock); }      // always in the same order
+
+        using iterator = typename tree_type::const_iterator;
+        std::vector<std::pair<iterator, iterator>> heads;
+        heads.reserve(N);
+        for (const auto & s : shards) {
+            if (!s.tree.empty()) { heads.emplace_back(s.tree.cbegin(), s.tree.cend()); }
+        }
+        while (!heads.empty()) {
+            std::size_t smallest = 0;
+            for (std::size_t i = 1; i < heads.size(); ++i) {
+                if (comp(heads[i].first->first, heads[smallest].first->first)) { smallest = i; }
+            }
+            auto & head = heads[smallest];
+            visit(head.first->first, head.first->second);
+            if (++head.first == head.second) {
+                head = heads.back();
+                heads.pop_back();
+            }
+        }
+    }
+};
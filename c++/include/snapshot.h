@@ -0,0 +1,247 @@
+/**
+* @file snapshot.h
+*
+* @brief Binary snapshots of a Tree: the file format, written by Tree::save and read by Tree::load and MappedTree
+*
+*
+*/
+#pragma once
+
+#include <algorithm> // min
+#include <cstddef>   // size_t
+#include <cstdint>   // uint32_t, uint64_t
+#include <cstring>   // memcpy
+#include <fstream>
+#include <functional> // std::less
+#include <iterator>  // iterator tags
+#include <limits>
+#include <stdexcept> // runtime_error
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>   // pair
+#include <vector>
+
+
+
+/*! Snapshot layout, all integers in the byte order of the machine that wrote it:
+    - header: the fields of detail::snapshot_header, 48 bytes
+    - payload: one record per pair, in order of key: key length (4 bytes), key bytes, value length (4 bytes),
+      value bytes; then the offset of every record from the start of the payload, 8 bytes each.
+    The checksum is the 64 bit FNV-1a hash of the payload */
+namespace detail {
+
+    /*! how keys and values are stored in a snapshot: trivially copyable types as their bytes */
+    template <class T>
+    struct snapshot_traits {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "snapshots support trivially copyable types and strings of single byte characters");
+        /*! type read from a mapped snapshot: a copy of the object, or a view of the characters of a string */
+        using view = T;
+        /*! bytes of every object, 0 if variable */
+        static constexpr std::uint32_t fixed_size = sizeof(T);
+
+        static const char * bytes(const T & object) noexcept { return reinterpret_cast<const char *>(&object); }
+        static std::size_t size(const T &) noexcept { return sizeof(T); }
+        static view view_of(const char * data, std::uint32_t) noexcept {
+            T object;
+            std::memcpy(&object, data, sizeof(T));
+            return object;
+        }
+    };
+
+    /*! strings are stored as their characters, and viewed in place */
+    template <class Char, class Traits, class Alloc>
+    struct snapshot_traits<std::basic_string<Char, Traits, Alloc>> {
+        static_assert(sizeof(Char) == 1, "characters in a snapshot are not aligned: only single byte characters are supported");
+        using view = std::basic_string_view<Char, Traits>;
+        static constexpr std::uint32_t fixed_size = 0;
+
+        static const char * bytes(const std::basic_string<Char, Traits, Alloc> & text) noexcept {
+            return reinterpret_cast<const char *>(text.data());
+        }
+        static std::size_t size(const std::basic_string<Char, Traits, Alloc> & text) noexcept { return text.size(); }
+        static view view_of(const char * data, std::uint32_t length) noexcept {
+            return view(reinterpret_cast<const Char *>(data), length);
+        }
+    };
+
+    /*! first bytes of every snapshot file */
+    struct snapshot_header {
+        char magic[8] = {'A', 'P', 'S', 'N', 'A', 'P', '0', '1'};
+        std::uint64_t byte_order = 0x0102030405060708;
+        std::uint32_t key_size = 0;         // snapshot_traits<K>::fixed_size
+        std::uint32_t value_size = 0;
+        std::uint64_t count = 0;            // number of pairs
+        std::uint64_t payload = 0;          // bytes after the header
+        std::uint64_t checksum = 0;
+    };
+
+    /*! true if header starts a snapshot of pairs of key and value sizes as given, written on this machine */
+    inline bool validHeader(const snapshot_header & header, std::uint32_t key_size, std::uint32_t value_size) noexcept {
+        const snapshot_header expected;
+        return std::equal(std::begin(header.magic), std::end(header.magic), expected.magic)
+            && header.byte_order == expected.byte_order && header.key_size == key_size && header.value_size == value_size
+            && header.count <= header.payload / 8;
+    }
+
+    /*! FNV-1a hash of [data, data + size), continuing from hash */
+    inline std::uint64_t fnv1a(std::uint64_t hash, const char * data, std::size_t size) noexcept {
+        for (std::size_t i = 0; i < size; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * 0x100000001b3;
+        }
+        return hash;
+    }
+    constexpr std::uint64_t fnv1a_basis = 0xcbf29ce484222325;
+
+    /*! writes a snapshot of the count pairs of [first, last), sorted by key, to path. False if a key or value
+        is larger than 4 GB or the file cannot be written */
+    template <class K, class T, class InputIt>
+    bool writeSnapshot(const std::string & path, InputIt first, InputIt last, std::size_t count) {
+        using key_traits = snapshot_traits<K>;
+        using value_traits = snapshot_traits<T>;
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        snapshot_header header;
+        header.key_size = key_traits::fixed_size;
+        header.value_size = value_traits::fixed_size;
+        header.count = count;
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        std::uint64_t hash = fnv1a_basis, offset = 0;
+        auto put = [&out, &hash, &offset](const char * data, std::size_t size) {
+            out.write(data, static_cast<std::streamsize>(size));
+            hash = fnv1a(hash, data, size);
+            offset += size;
+        };
+        auto put_field = [&put](const char * data, std::size_t size) {
+            if (size > std::numeric_limits<std::uint32_t>::max()) { return false; }
+            const auto length = static_cast<std::uint32_t>(size);
+            put(reinterpret_cast<const char *>(&length), sizeof(length));
+            put(data, size);
+            return true;
+        };
+        std::vector<std::uint64_t> offsets;
+        offsets.reserve(count);
+        for (; first != last; ++first) {
+            offsets.push_back(offset);
+            if (!put_field(key_traits::bytes(first->first), key_traits::size(first->first))
+                || !put_field(value_traits::bytes(first->second), value_traits::size(first->second))) {
+                return false;
+            }
+        }
+        put(reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(std::uint64_t));
+
+        header.payload = offset;
+        header.checksum = hash;
+        out.seekp(0);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        return static_cast<bool>(out.flush());
+    }
+
+    /*! the records of a snapshot held in memory, read in place: whole in a buffer for Tree::load, mapped by
+        MappedTree. Offsets and lengths come from the file, whose checksum is not always verified: every field
+        is bounds checked when it is read */
+    template <class K, class T>
+    class snapshot_records {
+
+        using key_traits = snapshot_traits<K>;
+        using value_traits = snapshot_traits<T>;
+
+        const char * payload = nullptr;
+        const char * offsets = nullptr;
+        std::size_t count = 0;
+
+        /*! offset of the i-th record from the start of the payload */
+        std::uint64_t record(std::size_t i) const noexcept {
+            std::uint64_t offset;
+            std::memcpy(&offset, offsets + i * sizeof(offset), sizeof(offset));
+            return offset;
+        }
+
+        /*! bytes and length of the field at offset from the start of the payload. Throws std::runtime_error
+            if the field does not lie within the records, or has not the size of a fixed_size type */
+        std::pair<const char *, std::uint32_t> field(std::uint64_t offset, std::uint32_t fixed_size) const {
+            const auto records = static_cast<std::uint64_t>(offsets - payload);
+            std::uint32_t size = 0;
+            if (offset > records || records - offset < sizeof(size)) {
+                throw std::runtime_error("snapshot: corrupted file, record out of bounds");
+            }
+            std::memcpy(&size, payload + offset, sizeof(size));
+            if (records - offset - sizeof(size) < size || (fixed_size != 0 && size != fixed_size)) {
+                throw std::runtime_error("snapshot: corrupted file, field out of bounds");
+            }
+            return {payload + offset + sizeof(size), size};
+        }
+
+    public:
+
+        using key_view = typename key_traits::view;
+        using value_view = typename value_traits::view;
+
+        /*! reads the snapshot in [data, data + length). With verify the checksum of the whole payload is checked,
+            otherwise only the header is. False, leaving the records empty, if it is not a snapshot of keys and
+            values of these types, written on this machine */
+        bool assign(const char * data, std::size_t length, bool verify) noexcept {
+            *this = snapshot_records();
+            snapshot_header header;
+            if (length < sizeof(header)) { return false; }
+            std::memcpy(&header, data, sizeof(header));
+            if (!validHeader(header, key_traits::fixed_size, value_traits::fixed_size)
+                || header.payload != length - sizeof(header)
+                || (verify && fnv1a(fnv1a_basis, data + sizeof(header), header.payload) != header.checksum)) {
+                return false;
+            }
+            payload = data + sizeof(header);
+            count = static_cast<std::size_t>(header.count);
+            offsets = payload + header.payload - count * sizeof(std::uint64_t);
+            return true;
+        }
+
+        std::size_t size() const noexcept { return count; }
+
+        /*! key and value of the i-th pair in order, read in place. Throw std::runtime_error if the record
+            is corrupted, reaching out of the snapshot */
+        key_view key_at(std::size_t i) const {
+            const auto key = field(record(i), key_traits::fixed_size);
+            return key_traits::view_of(key.first, key.second);
+        }
+        value_view value_at(std::size_t i) const {
+            const std::uint64_t offset = record(i);
+            const auto key = field(offset, key_traits::fixed_size);
+            const auto value = field(offset + sizeof(std::uint32_t) + key.second, value_traits::fixed_size);
+            return value_traits::view_of(value.first, value.second);
+        }
+
+        /*! reads the pairs as K and T, for Tree::load */
+        class decoding_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::pair<K, T>;
+            using difference_type = std::ptrdiff_t;
+            using reference = value_type;
+            using pointer = void;
+
+            decoding_iterator(const snapshot_records * owner, std::size_t position) : records(owner), i(position) {}
+            value_type operator*() const { return {K(records->key_at(i)), T(records->value_at(i))}; }
+            decoding_iterator & operator++() { ++i; return *this; }
+            decoding_iterator operator++(int) { auto old = *this; ++i; return old; }
+            friend bool operator== (const decoding_iterator & lhs, const decoding_iterator & rhs) { return lhs.i == rhs.i; }
+            friend bool operator!= (const decoding_iterator & lhs, const decoding_iterator & rhs) { return lhs.i != rhs.i; }
+
+        private:
+            const snapshot_records * records;
+            std::size_t i;
+        };
+    };
+
+    /*! reads the whole file at path in bytes. False if it cannot be read */
+    inline bool readFile(const std::string & path, std::vector<char> & bytes) {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) { return false; }
+        const std::streamoff size = in.tellg();
+        if (size < 0) { return false; }
+        bytes.resize(static_cast<std::size_t>(size));
+        in.seekg(0);
+        return static_cast<bool>(in.read(bytes.data(), size));
+    }
+}
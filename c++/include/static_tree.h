@@ -0,0 +1,192 @@
+/**
+* @file static_tree.h
+*
+* @brief Read-only map built at compile time from a literal table
+*
+*
+*/
+#pragma once
+
+#include <cstddef>   // size_t
+#include <functional> // std::less
+#include <iterator>  // forward_iterator_tag
+#include <stdexcept> // std::invalid_argument, std::out_of_range
+#include <utility>   // pair, index_sequence
+
+#include "frozen_tree.h"   // eytzingerFirst, eytzingerNext, eytzingerUndoRightTurns
+
+
+
+namespace detail {
+
+    /*! levels of a complete binary tree with n nodes */
+    constexpr std::size_t treeLevels(std::size_t n) noexcept {
+        std::size_t levels = 0;
+        while ((std::size_t{1} << levels) <= n) { ++levels; }
+        return levels;
+    }
+}
+
+
+/*! Read-only map of N pairs, built by make_static_tree() from a braced list, usually as a constexpr variable:
+    the pairs are sorted and laid out in Eytzinger (BFS) order by the compiler, and the whole map is a
+    literal type placed in read-only data, with no initialization at startup. The layout is padded to a
+    perfect tree repeating the greatest pair, up to twice the room of N pairs, so that find() descends with
+    no loop and no branch: one unrolled step per level, at compile time too. Iterators, in key order,
+    dereference to pairs of references, as FrozenTree's. K, T and Compare must be usable in constant
+    expressions for a constexpr map, e.g. integers, enums, std::string_view, function pointers */
+template <class K, class T, std::size_t N, class Compare = std::less<K>>
+class StaticTree {
+
+    static_assert(N > 0, "StaticTree needs at least one pair");
+
+    /*! levels of the complete tree holding N keys */
+    static constexpr std::size_t levels = detail::treeLevels(N);
+
+    /*! positions of the perfect tree: the pairs after the N-th repeat the greatest one */
+    static constexpr std::size_t slots = (std::size_t{1} << levels) - 1;
+
+    /*! keys and values in BFS order, 1-based: position 0 is padding */
+    K keys[slots + 1] {};
+    T values[slots + 1] {};
+    /*! position of the greatest pair, the last one visited by iterators */
+    std::size_t last = 0;
+    Compare comp {};
+
+    /*! one step of the descent: right if the key at k is smaller than key */
+    template <class Key>
+    constexpr std::size_t step(std::size_t k, const Key & key) const {
+        return 2 * k + (comp(keys[k], key) ? 1 : 0);
+    }
+
+    /*! a step for each level: the tree is perfect, so they need no bound check */
+    template <class Key, std::size_t... Level>
+    constexpr std::size_t descend(const Key & key, std::index_sequence<Level...>) const {
+        std::size_t k = 1;
+        ((k = (static_cast<void>(Level), step(k, key))), ...);
+        return k;
+    }
+
+    /*! 1-based BFS position of the pair with the given key, 0 if missing */
+    template <class Key>
+    constexpr std::size_t locate(const Key & key) const {
+        std::size_t k = descend(key, std::make_index_sequence<levels>());
+        k = detail::eytzingerUndoRightTurns(k);     // k is now the lower bound
+        if (k == 0 || comp(key, keys[k])) { return 0; }
+        return k;
+    }
+
+public:
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const K, T>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const K &, const T &>;
+        /*! operator-> needs a pointer to the pair of references built on the fly */
+        struct pointer {
+            reference ref;
+            constexpr const reference * operator->() const noexcept { return &ref; }
+        };
+
+        constexpr const_iterator() = default;
+        constexpr const_iterator(const StaticTree * owner, std::size_t position) : tree(owner), k(position) {}
+
+        constexpr reference operator*() const { return {tree->keys[k], tree->values[k]}; }
+        constexpr pointer operator->() const { return pointer{**this}; }
+        constexpr const_iterator & operator++() {
+            k = k == tree->last ? 0 : detail::eytzingerNext(k, slots);
+            return *this;
+        }
+        constexpr const_iterator operator++(int) {
+            auto old = *this;
+            ++(*this);
+            return old;
+        }
+        friend constexpr bool operator== (const const_iterator & lhs, const const_iterator & rhs) { return lhs.k == rhs.k; }
+        friend constexpr bool operator!= (const const_iterator & lhs, const const_iterator & rhs) { return !(lhs == rhs); }
+
+    private:
+        const StaticTree * tree = nullptr;
+        std::size_t k = 0;                  // 1-based BFS position, 0 is end()
+    };
+
+    using iterator = const_iterator;
+
+    /*! sorts the pairs by key and lays them out; a key given twice is an error, at compile time
+        for a constexpr map */
+    constexpr StaticTree(const std::pair<K, T> (&pairs)[N], const Compare & compare = Compare())
+    : comp(compare)
+    {
+        std::size_t order[N + 1] {};                // insertion sort of the positions: N is small
+        for (std::size_t i = 0; i < N; ++i) {
+            std::size_t j = i;
+            for (; j > 0 && comp(pairs[i].first, pairs[order[j - 1]].first); --j) { order[j] = order[j - 1]; }
+            order[j] = i;
+        }
+        for (std::size_t i = 1; i < N; ++i) {
+            if (!comp(pairs[order[i - 1]].first, pairs[order[i]].first)) {
+                throw std::invalid_argument("StaticTree: duplicate key");
+            }
+        }
+        std::size_t k = detail::eytzingerFirst(slots);
+        for (std::size_t i = 0; i < slots; ++i) {
+            const auto & pair = pairs[order[i < N ? i : N - 1]];
+            keys[k] = pair.first;
+            values[k] = pair.second;
+            if (i == N - 1) { last = k; }
+            k = detail::eytzingerNext(k, slots);
+        }
+    }
+
+    constexpr std::size_t size() const noexcept { return N; }
+    constexpr bool empty() const noexcept { return N == 0; }
+
+    /*! iterator to the pair with the given key, end() if missing */
+    constexpr const_iterator find(const K & key) const {
+        return const_iterator(this, locate(key));
+    }
+
+    /*! find with a key of any type comparable with K, only available with a transparent comparator */
+    template <class Key, class C = Compare, class = typename C::is_transparent>
+    constexpr const_iterator find(const Key & key) const {
+        return const_iterator(this, locate(key));
+    }
+
+    /*! value of key, as the const Tree::operator[]: throws std::out_of_range if key is missing */
+    constexpr const T & operator[](const K & key) const {
+        const std::size_t k = locate(key);
+        if (k == 0) { throw std::out_of_range("StaticTree::operator[]: key not found"); }
+        return values[k];
+    }
+
+    constexpr Compare key_comp() const { return comp; }
+
+    constexpr const_iterator begin()  const { return const_iterator(this, detail::eytzingerFirst(slots)); }
+    constexpr const_iterator cbegin() const { return begin(); }
+    constexpr const_iterator end()    const { return const_iterator(this, 0); }
+    constexpr const_iterator cend()   const { return end(); }
+};
+
+
+/*! builds a StaticTree from a braced list of pairs, whose size gives N:
+    constexpr auto table = make_static_tree<int, std::string_view>({{404, "not found"}, {200, "ok"}}); */
+template <class K, class T, class Compare = std::less<K>, std::size_t N>
+constexpr StaticTree<K, T, N, Compare> make_static_tree(const std::pair<K, T> (&pairs)[N], const Compare & compare = Compare()) {
+    return StaticTree<K, T, N, Compare>(pairs, compare);
+}
+
+
+template<class K, class T, std::size_t N, class Compare>
+std::ostream& operator<<(std::ostream& ostream, const StaticTree<K,T,N,Compare>& tree) {
+
+    if (tree.empty()) {
+        ostream << "Error: printing empty tree";
+        return ostream;
+    }
+    for (auto t=tree.cbegin();t!=tree.cend();++t){
+        ostream << std::left << std::setw(12)<< t->first << ":" << t->second << "\n";
+    }
+  return ostream;
+}
@@ -0,0 +1,151 @@
+/**
+* @file thread_pool.h
+*
+* @brief Fork-join thread pool used by the parallel algorithms of Tree
+*
+*
+*/
+#pragma once
+
+#include <algorithm> // stable_sort, inplace_merge
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>   // size_t
+#include <deque>
+#include <exception> // exception_ptr
+#include <functional>
+#include <iterator>  // iterator_traits
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+
+/*! Fixed set of worker threads running fork-join tasks. invoke(f, g) runs f on the calling thread and offers g
+    to the workers; while waiting for g, the caller runs queued tasks itself, so tasks can fork again without
+    ever blocking a thread. A pool of size 1 has no workers and runs everything on the caller */
+class thread_pool {
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex lock;
+    std::condition_variable ready;
+    bool stopping = false;
+
+    /*! runs a queued task, if any. False if the queue was empty */
+    bool run_one() {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (tasks.empty()) { return false; }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+        return true;
+    }
+
+    void work() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                ready.wait(guard, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) { return; }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+public:
+
+    /*! pool running tasks on threads threads, the caller of invoke included */
+    explicit thread_pool(unsigned threads = std::thread::hardware_concurrency()) {
+        for (unsigned i = 1; i < threads; ++i) { workers.emplace_back([this] { work(); }); }
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool & operator=(const thread_pool &) = delete;
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (auto & worker : workers) { worker.join(); }
+    }
+
+    /*! number of threads running tasks, the caller of invoke included */
+    std::size_t size() const noexcept { return workers.size() + 1; }
+
+    /*! runs f and g, possibly in parallel, and returns when both are done. If one throws, the exception is
+        rethrown after both have finished (the one of f if both throw) */
+    template <class F, class G>
+    void invoke(F && f, G && g) {
+        if (workers.empty()) {
+            f();
+            g();
+            return;
+        }
+        std::atomic<bool> done{false};
+        std::exception_ptr failure;
+        try {
+            std::lock_guard<std::mutex> guard(lock);
+            tasks.emplace_back([&g, &done, &failure] {
+                try { g(); } catch (...) { failure = std::current_exception(); }
+                done.store(true, std::memory_order_release);
+            });
+        } catch (...) {                 // the task could not be queued: run both here
+            f();
+            g();
+            return;
+        }
+        ready.notify_one();
+
+        std::exception_ptr first;
+        try { f(); } catch (...) { first = std::current_exception(); }
+        while (!done.load(std::memory_order_acquire)) {
+            if (!run_one()) { std::this_thread::yield(); }
+        }
+        if (first) { std::rethrow_exception(first); }
+        if (failure) { std::rethrow_exception(failure); }
+    }
+
+    /*! pool shared by the whole program, one thread per hardware thread */
+    static thread_pool & shared() {
+        static thread_pool pool;
+        return pool;
+    }
+};
+
+
+namespace detail {
+
+    /*! calls f(i) for every i in [first, last), splitting the range in halves run in parallel */
+    template <class F>
+    void parallelFor(thread_pool & pool, std::size_t first, std::size_t last, const F & f) {
+        if (last - first == 1) {
+            f(first);
+        } else if (last > first) {
+            const std::size_t middle = first + (last - first) / 2;
+            pool.invoke([&] { parallelFor(pool, first, middle, f); }, [&] { parallelFor(pool, middle, last, f); });
+        }
+    }
+
+    /*! merge sort: halves are sorted in parallel, and merged; std::stable_sort below cutoff elements */
+    template <class RandomIt, class Less>
+    void parallelStableSort(thread_pool & pool, RandomIt first, RandomIt last, Less less, std::size_t cutoff) {
+        const auto count = static_cast<std::size_t>(last - first);
+        if (count <= cutoff || pool.size() < 2) {
+            std::stable_sort(first, last, less);
+            return;
+        }
+        const RandomIt middle = first + static_cast<typename std::iterator_traits<RandomIt>::difference_type>(count / 2);
+        pool.invoke([&] { parallelStableSort(pool, first, middle, less, cutoff); },
+                    [&] { parallelStableSort(pool, middle, last, less, cutoff); });
+        std::inplace_merge(first, middle, last, less);
+    }
+}
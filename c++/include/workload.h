@@ -0,0 +1,298 @@
+/**
+* @file workload.h
+*
+* @brief Seeded workload generator: random numbers, key distributions, operation mixes and binary traces
+*
+*
+*/
+#pragma once
+
+#include <algorithm> // generate_n
+#include <cmath>     // pow
+#include <cstddef>   // size_t
+#include <cstdint>   // uint64_t
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept> // invalid_argument
+#include <string>
+#include <vector>
+
+
+
+/*! namespace for the generation of reproducible workloads, for benchmarks and trace replay */
+namespace workload {
+
+    /*! high 64 bits of the 128 bit product of a and b: a single instruction where the compiler has 128 bit
+        integers, four 32 bit products otherwise */
+    inline std::uint64_t multiplyHigh(std::uint64_t a, std::uint64_t b) noexcept {
+#if defined(__SIZEOF_INT128__)
+        return static_cast<std::uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+        const std::uint64_t a_low = a & 0xffffffff, a_high = a >> 32;
+        const std::uint64_t b_low = b & 0xffffffff, b_high = b >> 32;
+        const std::uint64_t low = a_low * b_low;
+        const std::uint64_t middle = a_high * b_low + (low >> 32);           // cannot overflow
+        const std::uint64_t cross = a_low * b_high + (middle & 0xffffffff);
+        return a_high * b_high + (middle >> 32) + (cross >> 32);
+#endif
+    }
+
+    /*! xoshiro256** random number generator: a few instructions per number, 32 bytes of state, and the same
+        sequence for the same seed on every platform. Usable with the <random> distributions */
+    class rng {
+        std::uint64_t state[4];
+
+        static std::uint64_t rotl(std::uint64_t x, int k) noexcept { return (x << k) | (x >> (64 - k)); }
+
+    public:
+        using result_type = std::uint64_t;
+        static constexpr result_type min() noexcept { return 0; }
+        static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+        /*! the state is filled from seed with splitmix64, so that close seeds give unrelated sequences */
+        explicit rng(std::uint64_t seed = 42) noexcept {
+            for (auto & word : state) {
+                seed += 0x9e3779b97f4a7c15;
+                std::uint64_t z = seed;
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+                word = z ^ (z >> 31);
+            }
+        }
+
+        result_type operator()() noexcept {
+            const std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+            const std::uint64_t t = state[1] << 17;
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= t;
+            state[3] = rotl(state[3], 45);
+            return result;
+        }
+
+        /*! uniform number in [0, bound), without divisions (Lemire's multiply and shift) */
+        std::uint64_t below(std::uint64_t bound) noexcept {
+            return multiplyHigh((*this)(), bound);
+        }
+
+        /*! uniform number in [0, 1) */
+        double unit() noexcept { return static_cast<double>((*this)() >> 11) * 0x1.0p-53; }
+    };
+
+    /*! random string of length letters and digits */
+    inline std::string random_string(std::size_t length, rng & generator) {
+        static const char charset[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+        std::string str(length, 0);
+        std::generate_n(str.begin(), length, [&generator] { return charset[generator.below(sizeof(charset) - 1)]; });
+        return str;
+    }
+
+    /*! how the keys of a workload are spread over the key space [0, key_space) */
+    enum class distribution {
+        uniform,            // every key equally likely
+        zipf,               // key k drawn with probability proportional to 1 / (k + 1)^skew: 0 is the hottest
+        sorted,             // 0, 1, 2... wrapping around at key_space
+        reverse_sorted,     // key_space - 1, key_space - 2...
+        clustered,          // runs of cluster consecutive keys, starting at random keys
+        hot_set             // hot_fraction of the draws from a set of hot_keys scattered keys, the others uniform
+    };
+
+    /*! name of d, as accepted by parse */
+    inline const char * name(distribution d) {
+        switch (d) {
+            case distribution::uniform: return "uniform";
+            case distribution::zipf: return "zipf";
+            case distribution::sorted: return "sorted";
+            case distribution::reverse_sorted: return "reverse_sorted";
+            case distribution::clustered: return "clustered";
+            case distribution::hot_set: return "hot_set";
+        }
+        return "";
+    }
+
+    /*! distribution called text, false if there is none */
+    inline bool parse(const std::string & text, distribution & d) {
+        for (auto candidate : {distribution::uniform, distribution::zipf, distribution::sorted,
+                               distribution::reverse_sorted, distribution::clustered, distribution::hot_set}) {
+            if (text == name(candidate)) {
+                d = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*! tuning of the distributions, ignored by those not using them */
+    struct shape {
+        double skew = 0.99;             // zipf exponent in (0, 1), 0.99 as in YCSB
+        std::uint64_t cluster = 64;     // length of the runs of clustered
+        std::uint64_t hot_keys = 0;     // size of the hot set, key_space / 100 if 0
+        double hot_fraction = 0.9;      // draws falling in the hot set
+    };
+
+    /*! infinite sequence of keys in [0, key_space) following a distribution */
+    class key_generator {
+        distribution kind;
+        std::uint64_t space;
+        shape params;
+        rng generator;
+        std::uint64_t next_key = 0;     // sorted, reverse_sorted, clustered: next key of the sequence or run
+        std::uint64_t run_left = 0;     // clustered: keys left in the current run
+        double zeta_n = 0, alpha = 0, eta = 0;
+
+        /*! sum of 1 / i^skew for i in [1, n]: exact up to a million terms, then integrated */
+        static double zeta(std::uint64_t n, double skew) {
+            const std::uint64_t exact = std::min<std::uint64_t>(n, 1000000);
+            double sum = 0;
+            for (std::uint64_t i = 1; i <= exact; ++i) { sum += std::pow(static_cast<double>(i), -skew); }
+            if (n > exact) {
+                sum += (std::pow(static_cast<double>(n), 1 - skew) - std::pow(static_cast<double>(exact), 1 - skew)) / (1 - skew);
+            }
+            return sum;
+        }
+
+        /*! i-th hot key: hot keys are spread over the key space instead of lying next to each other */
+        std::uint64_t hot_key(std::uint64_t i) const noexcept {
+            return multiplyHigh(i * 0x9e3779b97f4a7c15, space);
+        }
+
+    public:
+        /*! throws std::invalid_argument for zipf with a skew outside (0, 1), where the approximation
+            of Gray et al. does not hold */
+        key_generator(distribution d, std::uint64_t key_space, std::uint64_t seed, shape tuning = shape())
+        : kind(d), space(key_space ? key_space : 1), params(tuning), generator(seed)
+        {
+            if (params.hot_keys == 0) { params.hot_keys = std::max<std::uint64_t>(1, space / 100); }
+            if (kind == distribution::zipf) {   // Gray et al., "Quickly generating billion-record synthetic databases"
+                if (!(params.skew > 0 && params.skew < 1)) {
+                    throw std::invalid_argument("key_generator: zipf skew must be in (0, 1)");
+                }
+                zeta_n = zeta(space, params.skew);
+                alpha = 1 / (1 - params.skew);
+                eta = (1 - std::pow(2.0 / static_cast<double>(space), 1 - params.skew)) / (1 - zeta(2, params.skew) / zeta_n);
+            }
+            if (kind == distribution::reverse_sorted) { next_key = space - 1; }
+        }
+
+        std::uint64_t operator()() {
+            switch (kind) {
+                case distribution::uniform:
+                    return generator.below(space);
+                case distribution::zipf: {
+                    const double u = generator.unit();
+                    const double uz = u * zeta_n;
+                    if (uz < 1) { return 0; }
+                    if (uz < 1 + std::pow(0.5, params.skew)) { return std::min<std::uint64_t>(1, space - 1); }
+                    const auto key = static_cast<std::uint64_t>(static_cast<double>(space) * std::pow(eta * u - eta + 1, alpha));
+                    return std::min(key, space - 1);
+                }
+                case distribution::sorted: {
+                    const std::uint64_t key = next_key;
+                    next_key = next_key + 1 == space ? 0 : next_key + 1;
+                    return key;
+                }
+                case distribution::reverse_sorted: {
+                    const std::uint64_t key = next_key;
+                    next_key = next_key == 0 ? space - 1 : next_key - 1;
+                    return key;
+                }
+                case distribution::clustered: {
+                    if (run_left == 0) {
+                        next_key = generator.below(space);
+                        run_left = params.cluster;
+                    }
+                    --run_left;
+                    const std::uint64_t key = next_key;
+                    next_key = next_key + 1 == space ? 0 : next_key + 1;
+                    return key;
+                }
+                case distribution::hot_set:
+                    if (generator.unit() < params.hot_fraction) { return hot_key(generator.below(params.hot_keys)); }
+                    return generator.below(space);
+            }
+            return 0;
+        }
+    };
+
+    /*! operation of a workload */
+    enum class op : std::uint8_t { find = 0, insert = 1, erase = 2 };
+
+    /*! one operation on one key */
+    struct request {
+        op kind;
+        std::uint64_t key;
+    };
+
+    /*! shares of finds, inserts and erases: any positive weights, e.g. {90, 9, 1} */
+    struct mix {
+        unsigned reads = 1;
+        unsigned writes = 0;
+        unsigned erases = 0;
+    };
+
+    /*! count requests, with keys drawn from keys and operations in the proportions of m */
+    inline std::vector<request> make_trace(key_generator & keys, mix m, std::size_t count, rng & generator) {
+        const std::uint64_t total = std::uint64_t{m.reads} + m.writes + m.erases;
+        std::vector<request> trace(count);
+        for (auto & item : trace) {
+            const std::uint64_t dice = total ? generator.below(total) : 0;
+            item.kind = dice < m.reads ? op::find : dice < std::uint64_t{m.reads} + m.writes ? op::insert : op::erase;
+            item.key = keys();
+        }
+        return trace;
+    }
+
+    /*! binary trace format: the 8 bytes of trace_magic, the number of requests as 8 bytes little endian,
+        then 9 bytes per request: the op, and the key little endian */
+    constexpr char trace_magic[8] = {'A', 'P', 'T', 'R', 'A', 'C', 'E', '1'};
+
+    namespace detail {
+        inline void putWord(char * out, std::uint64_t word) noexcept {
+            for (int i = 0; i < 8; ++i) { out[i] = static_cast<char>((word >> (8 * i)) & 0xff); }
+        }
+
+        inline std::uint64_t getWord(const char * in) noexcept {
+            std::uint64_t word = 0;
+            for (int i = 0; i < 8; ++i) { word |= std::uint64_t{static_cast<unsigned char>(in[i])} << (8 * i); }
+            return word;
+        }
+    }
+
+    /*! writes trace to out in the binary trace format. False if the stream failed */
+    inline bool write_trace(std::ostream & out, const std::vector<request> & trace) {
+        char header[16];
+        std::copy(std::begin(trace_magic), std::end(trace_magic), header);
+        detail::putWord(header + 8, trace.size());
+        out.write(header, sizeof(header));
+        char record[9];
+        for (const auto & item : trace) {
+            record[0] = static_cast<char>(item.kind);
+            detail::putWord(record + 1, item.key);
+            out.write(record, sizeof(record));
+        }
+        return static_cast<bool>(out);
+    }
+
+    /*! reads a trace written by write_trace into trace. False, leaving trace empty, if the stream is not a trace,
+        is truncated or holds an unknown op */
+    inline bool read_trace(std::istream & in, std::vector<request> & trace) {
+        trace.clear();
+        char header[16];
+        if (!in.read(header, sizeof(header)) || !std::equal(std::begin(trace_magic), std::end(trace_magic), header)) {
+            return false;
+        }
+        const std::uint64_t count = detail::getWord(header + 8);
+        char record[9];
+        for (std::uint64_t i = 0; i < count; ++i) {
+            if (!in.read(record, sizeof(record)) || static_cast<unsigned char>(record[0]) > 2) {
+                trace.clear();
+                return false;
+            }
+            trace.push_back({static_cast<op>(record[0]), detail::getWord(record + 1)});
+        }
+        return true;
+    }
+}
@@ -0,0 +1,83 @@
+/*
+batched lookup benchmark program
+compares a loop of find() with find_batch(), for several numbers of searches in flight,
+on an AVL Tree filled with random keys, best when the tree is much larger than the last level cache
+
+gets 2 arguments:
+1) number_of_elements to put in the tree
+2) number of lookups, of random keys present in the tree
+
+example: ./batch_benchmark 20000000 10000000
+
+*/
+
+#include "binary_tree.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+using tree_type = Tree<std::uint64_t, std::uint64_t, std::less<std::uint64_t>, balancing::avl>;
+
+/*! lookups are resolved in requests of this many keys, as when resolving the IDs listed in a request */
+constexpr std::size_t request_size = 256;
+
+/*! average time of a lookup, in nanoseconds. The values found are summed, so that the lookups are not optimized away */
+template <class Lookup>
+double measure(const std::vector<std::uint64_t> & lookups, std::uint64_t & checksum, Lookup && lookup)
+{
+    std::vector<tree_type::iterator> found(request_size);
+    auto start = clock_type::now();
+    for (std::size_t i = 0; i + request_size <= lookups.size(); i += request_size) {
+        lookup(lookups.data() + i, lookups.data() + i + request_size, found.data());
+        for (auto it : found) { checksum += it->second; }
+    }
+    auto stop = clock_type::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(lookups.size());
+}
+
+template <std::size_t Group>
+void report_batch(const tree_type & tree, const std::vector<std::uint64_t> & lookups, std::uint64_t & checksum)
+{
+    const double ns = measure(lookups, checksum, [&tree](const std::uint64_t * first, const std::uint64_t * last, tree_type::iterator * out) {
+        tree.find_batch<Group>(first, last, out);
+    });
+    std::cout << std::left << std::setw(24) << "find_batch<" + std::to_string(Group) + ">" << ns << std::endl;
+}
+
+int main (int argc, char* argv[])
+{
+    if (argc < 3) {
+        std::cout << "wrong number of args. expects 2" << std::endl;
+        return 0;
+    }
+    const auto elements = std::strtoull(argv[1], nullptr, 10);
+    const auto lookup_count = std::strtoull(argv[2], nullptr, 10);
+
+    std::mt19937_64 generator(42);
+    std::vector<std::uint64_t> keys(elements);
+    for (auto & key : keys) { key = generator(); }
+    tree_type tree;
+    for (auto key : keys) { tree.insert(key, key); }
+
+    std::vector<std::uint64_t> lookups(lookup_count);
+    for (auto & key : lookups) { key = keys[generator() % keys.size()]; }
+
+    std::uint64_t checksum = 0;
+    std::cout << "ns per lookup, " << elements << " keys, height " << tree.height() << std::endl;
+    const double ns = measure(lookups, checksum, [&tree](const std::uint64_t * first, const std::uint64_t * last, tree_type::iterator * out) {
+        for (; first != last; ++first, ++out) { *out = tree.find(*first); }
+    });
+    std::cout << std::left << std::setw(24) << "find" << ns << std::endl;
+    report_batch<4>(tree, lookups, checksum);
+    report_batch<8>(tree, lookups, checksum);
+    report_batch<16>(tree, lookups, checksum);
+    report_batch<32>(tree, lookups, checksum);
+    report_batch<64>(tree, lookups, checksum);
+    std::cout << "(checksum " << checksum << ")" << std::endl;
+    return 0;
+}
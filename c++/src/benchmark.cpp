@@ -0,0 +1,243 @@
+/*
+benchmark suite
+sweeps the number of keys over powers of 10 and measures, for Tree (unbalanced, after balance() and AVL),
+std::map and std::unordered_map: insert, find of present keys (find_hit), find of missing keys (find_miss),
+erase, iteration, copy, and balance() for Tree. Keys are random 64 bit integers drawn
+with workload::key_generator, as in the other drivers, values strings.
+
+Every measure is repeated after a warmup run. Insert, find and erase are timed in batches of batch_size
+elements, each batch a sample; iteration, copy and balance() give one sample per repetition. The CSV output
+has one line per structure, operation and size, with the number of samples and the minimum, mean and
+percentiles of the time per element over the samples, in nanoseconds:
+
+structure,operation,n,value_bytes,samples,min_ns,mean_ns,p50_ns,p90_ns,p99_ns
+
+gets 3 arguments, and an optional fourth:
+1) max_exponent: sizes are 10, 100, ... 10^max_exponent
+2) repetitions of each measure
+3) length in bytes of the string values
+4) output CSV file, standard output if missing
+
+example: ./benchmark 7 10 16 results.csv
+
+*/
+
+#include "binary_tree.h"
+#include "workload.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+using key_type = std::uint64_t;
+using value_type = std::string;
+
+/*! keeps the compiler from optimizing away the computation of value */
+template <class T>
+inline void do_not_optimize(const T & value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void * sink;
+    sink = &value;
+#endif
+}
+
+/*! input of every measure of a given size: present keys in insertion order, missing keys, lookups */
+struct dataset {
+    std::vector<key_type> keys;
+    std::vector<key_type> missing;
+    std::vector<key_type> hits;             // present keys, in random order, at least min_operations
+    std::vector<key_type> misses;
+    std::vector<key_type> erases;           // every present key once, in random order
+    value_type value;
+};
+
+/*! measures of small sizes are repeated up to this number of elements, to get above the clock resolution */
+constexpr std::size_t min_operations = std::size_t{1} << 16;
+
+dataset make_dataset(std::size_t n, std::size_t value_bytes, workload::rng & generator)
+{
+    workload::key_generator draw(workload::distribution::uniform, std::uint64_t{1} << 63, generator());
+    dataset data;
+    data.keys.resize(n);
+    data.missing.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        data.keys[i] = draw() << 1;                 // present keys are even,
+        data.missing[i] = (draw() << 1) | 1;        // missing ones odd
+    }
+    const std::size_t lookups = std::max(n, min_operations);
+    data.hits.resize(lookups);
+    data.misses.resize(lookups);
+    for (std::size_t i = 0; i < lookups; ++i) {
+        data.hits[i] = data.keys[generator.below(n)];
+        data.misses[i] = data.missing[generator.below(n)];
+    }
+    data.erases = data.keys;
+    std::shuffle(data.erases.begin(), data.erases.end(), generator);
+    data.value.assign(value_bytes, 'x');
+    return data;
+}
+
+/*! measures of single element operations are timed in batches of this number of elements, each giving a sample:
+    enough to stay above the clock resolution */
+constexpr std::size_t batch_size = 1024;
+
+/*! times f(first, last), which processes the elements in [first, last) of elements, in batches of batch elements,
+    warmup + repetitions times, and returns the ns per element of every batch of all the repetitions but the warmup.
+    prepare runs untimed before every run */
+template <class Prepare, class F>
+std::vector<double> measure(std::size_t repetitions, std::size_t elements, std::size_t batch, Prepare && prepare, F && f)
+{
+    std::vector<double> samples;
+    for (std::size_t run = 0; run <= repetitions; ++run) {
+        prepare();
+        for (std::size_t first = 0; first < elements; first += batch) {
+            const std::size_t last = std::min(first + batch, elements);
+            const auto start = clock_type::now();
+            f(first, last);
+            const auto stop = clock_type::now();
+            if (run > 0) {
+                samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(last - first));
+            }
+        }
+    }
+    return samples;
+}
+
+class report {
+    std::ostream & csv;
+    std::size_t value_bytes;
+public:
+    report(std::ostream & out, std::size_t bytes) : csv(out), value_bytes(bytes) {
+        csv << "structure,operation,n,value_bytes,samples,min_ns,mean_ns,p50_ns,p90_ns,p99_ns" << std::endl;
+    }
+
+    void row(const std::string & structure, const char * operation, std::size_t n, std::vector<double> samples) {
+        std::sort(samples.begin(), samples.end());
+        auto percentile = [&samples](double p) {    // nearest rank
+            const auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * static_cast<double>(samples.size())));
+            return samples[std::max<std::size_t>(rank, 1) - 1];
+        };
+        const double mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+        csv << structure << "," << operation << "," << n << "," << value_bytes << "," << samples.size() << ","
+            << samples.front() << "," << mean << "," << percentile(50) << "," << percentile(90) << "," << percentile(99)
+            << std::endl;
+    }
+};
+
+/*! true for maps with balance(), i.e. Tree */
+template <class Map, class = void>
+struct has_balance : std::false_type {};
+
+template <class Map>
+struct has_balance<Map, std::void_t<decltype(std::declval<Map &>().balance())>> : std::true_type {};
+
+/*! how the container is filled before the measures that need a full one */
+enum class shape { as_inserted, balanced };
+
+template <class Map>
+void run_suite(report & out, const std::string & name, shape layout, const dataset & data, std::size_t repetitions)
+{
+    const std::size_t n = data.keys.size();
+
+    Map full;
+    for (auto key : data.keys) { full.insert_or_assign(key, data.value); }
+    if constexpr (has_balance<Map>::value) {
+        if (layout == shape::balanced) { full.balance(); }
+    }
+
+    const std::size_t rounds = (min_operations + n - 1) / n;
+    if (layout == shape::as_inserted) {
+        std::vector<Map> maps;                      // a map filled with all the keys per round
+        out.row(name, "insert", n, measure(repetitions, rounds * n, batch_size, [&] { maps.clear(); maps.resize(rounds); },
+                                           [&](std::size_t first, std::size_t last) {
+            std::size_t round = first / n, i = first % n;
+            for (std::size_t element = first; element < last; ++element) {
+                maps[round].insert_or_assign(data.keys[i], data.value);
+                if (++i == n) { i = 0; ++round; }
+            }
+            do_not_optimize(maps);
+        }));
+    }
+
+    auto lookup = [&](const char * operation, const std::vector<key_type> & keys) {
+        out.row(name, operation, n, measure(repetitions, keys.size(), batch_size, [] {}, [&](std::size_t first, std::size_t last) {
+            std::size_t found = 0;
+            for (std::size_t i = first; i < last; ++i) { found += full.find(keys[i]) != full.end(); }
+            do_not_optimize(found);
+        }));
+    };
+    lookup("find_hit", data.hits);
+    lookup("find_miss", data.misses);
+
+    out.row(name, "iterate", n, measure(repetitions, rounds * n, rounds * n, [] {}, [&](std::size_t, std::size_t) {
+        std::size_t bytes = 0;
+        for (std::size_t round = 0; round < rounds; ++round) {
+            for (const auto & pair : full) { bytes += pair.second.size(); }
+        }
+        do_not_optimize(bytes);
+    }));
+
+    Map copy;
+    out.row(name, "copy", n, measure(repetitions, n, n, [&] { copy = Map(); }, [&](std::size_t, std::size_t) {
+        copy = full;
+        do_not_optimize(copy);
+    }));
+
+    out.row(name, "erase", n, measure(repetitions, n, batch_size, [&] { copy = full; }, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) { copy.erase(data.erases[i]); }
+        do_not_optimize(copy);
+    }));
+
+    if constexpr (has_balance<Map>::value) {
+        if (layout == shape::as_inserted) {
+            Map unbalanced;
+            out.row(name, "balance", n, measure(repetitions, n, n, [&] { unbalanced = full; }, [&](std::size_t, std::size_t) {
+                unbalanced.balance();
+                do_not_optimize(unbalanced);
+            }));
+        }
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    if (argc < 4) {
+        std::cout << "wrong number of args. expects 3 or 4" << std::endl;
+        return 0;
+    }
+    const auto max_exponent = std::strtoul(argv[1], nullptr, 10);
+    const auto repetitions = std::max<std::size_t>(1, std::strtoull(argv[2], nullptr, 10));
+    const auto value_bytes = std::strtoull(argv[3], nullptr, 10);
+    std::ofstream file;
+    if (argc > 4) { file.open(argv[4]); }
+    report out(argc > 4 ? file : std::cout, value_bytes);
+
+    workload::rng generator(42);
+    std::size_t n = 1;
+    for (unsigned long exponent = 1; exponent <= max_exponent; ++exponent) {
+        n *= 10;
+        const auto data = make_dataset(n, value_bytes, generator);
+        using tree = Tree<key_type, value_type>;
+        using avl = Tree<key_type, value_type, std::less<key_type>, balancing::avl>;
+        run_suite<tree>(out, "Tree", shape::as_inserted, data, repetitions);
+        run_suite<tree>(out, "Tree balanced", shape::balanced, data, repetitions);
+        run_suite<avl>(out, "Tree avl", shape::as_inserted, data, repetitions);
+        run_suite<std::map<key_type, value_type>>(out, "std::map", shape::as_inserted, data, repetitions);
+        run_suite<std::unordered_map<key_type, value_type>>(out, "std::unordered_map", shape::as_inserted, data, repetitions);
+        std::cerr << "done 10^" << exponent << std::endl;
+    }
+    return 0;
+}
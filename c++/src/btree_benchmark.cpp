@@ -0,0 +1,79 @@
+/*
+B+ tree benchmark program
+compares BTree with an AVL Tree and std::map, measuring the time per element of
+inserting random keys, looking them up, iterating in order and erasing them
+
+gets 1 argument:
+1) number_of_elements to put in the maps
+
+example: ./btree_benchmark 1000000
+
+*/
+
+#include "binary_tree.h"
+#include "btree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+
+/*! nanoseconds per element taken by action */
+template <class Action>
+double per_element(std::size_t elements, Action action)
+{
+    auto start = clock_type::now();
+    action();
+    auto stop = clock_type::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(elements);
+}
+
+template <class MapType>
+void report(const char * name, const std::vector<std::uint64_t> & keys, const std::vector<std::uint64_t> & shuffled)
+{
+    MapType map;
+    std::uint64_t checksum = 0;
+    const double insert = per_element(keys.size(), [&] { for (auto key : keys) { map.insert(key, key); } });
+    const double find = per_element(keys.size(), [&] { for (auto key : shuffled) { checksum += map.find(key)->second; } });
+    const double iterate = per_element(keys.size(), [&] { for (auto it = map.cbegin(); it != map.cend(); ++it) { checksum += it->second; } });
+    const double erase = per_element(keys.size(), [&] { for (auto key : shuffled) { map.erase(key); } });
+    std::cout << std::left << std::setw(12) << name << std::right
+              << std::setw(10) << insert << std::setw(10) << find
+              << std::setw(10) << iterate << std::setw(10) << erase
+              << "   (checksum " << checksum << ")" << std::endl;
+}
+
+/*! std::map with the insert(key, value) interface of Tree */
+struct std_map : std::map<std::uint64_t, std::uint64_t> {
+    void insert(std::uint64_t key, std::uint64_t value) { (*this)[key] = value; }
+};
+
+int main (int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cout << "wrong number of args. expects 1" << std::endl;
+        return 0;
+    }
+    const auto elements = std::strtoull(argv[1], nullptr, 10);
+
+    std::mt19937_64 generator(42);
+    std::vector<std::uint64_t> keys(elements);
+    for (auto & key : keys) { key = generator(); }
+    auto shuffled = keys;
+    std::shuffle(shuffled.begin(), shuffled.end(), generator);
+
+    std::cout << "ns per element, " << elements << " random keys" << std::endl;
+    std::cout << std::left << std::setw(12) << "" << std::right
+              << std::setw(10) << "insert" << std::setw(10) << "find"
+              << std::setw(10) << "iterate" << std::setw(10) << "erase" << std::endl;
+    report<BTree<std::uint64_t, std::uint64_t>>("BTree", keys, shuffled);
+    report<Tree<std::uint64_t, std::uint64_t, std::less<std::uint64_t>, balancing::avl>>("Tree, AVL", keys, shuffled);
+    report<std_map>("std::map", keys, shuffled);
+    return 0;
+}
@@ -0,0 +1,97 @@
+/*
+compact tree benchmark program
+compares the resident memory per entry and the lookup time of Tree, CompactTree and CompactTree without
+parent links, on uint64_t keys and uint32_t values, before and after balance().
+Each map is built in a child process, so that the memory freed by the previous one does not hide its own
+
+gets 2 arguments:
+1) number_of_elements to put in the maps
+2) number of lookups, of random keys present in the maps
+
+example: ./compact_benchmark 10000000 1000000
+
+*/
+
+#include "binary_tree.h"
+#include "compact_tree.h"
+#include "workload.h"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <sys/wait.h> // waitpid
+#include <unistd.h>   // fork, sysconf
+
+using clock_type = std::chrono::steady_clock;
+using key_type = std::uint64_t;
+using value_type = std::uint32_t;
+
+/*! resident memory of the process, in bytes */
+std::size_t resident_bytes()
+{
+    std::ifstream statm("/proc/self/statm");
+    std::size_t total = 0, resident = 0;
+    statm >> total >> resident;
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+/*! average time of a lookup, in nanoseconds */
+template <class MapType>
+double lookup_time(const MapType & map, const std::vector<key_type> & lookups)
+{
+    std::uint64_t checksum = 0;
+    auto start = clock_type::now();
+    for (auto key : lookups) { checksum += map.find(key)->second; }
+    auto stop = clock_type::now();
+    if (checksum == 42) { std::cout << ""; }       // keeps the lookups from being optimized away
+    return std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(lookups.size());
+}
+
+/*! builds the map in a child process, and prints bytes per entry and lookup times before and after balance */
+template <class MapType>
+void measure(const char * name, const std::vector<key_type> & keys, const std::vector<key_type> & lookups)
+{
+    std::cout.flush();
+    const pid_t child = fork();
+    if (child != 0) {
+        waitpid(child, nullptr, 0);
+        return;
+    }
+    const std::size_t before = resident_bytes();
+    MapType map;
+    for (auto key : keys) { map.insert(key, static_cast<value_type>(key)); }
+    const std::size_t after = resident_bytes();
+    const double unbalanced = lookup_time(map, lookups);
+    map.balance();
+    std::cout << std::left << std::setw(28) << name << std::right << std::setw(12)
+              << static_cast<double>(after - before) / static_cast<double>(keys.size())
+              << std::setw(12) << unbalanced << std::setw(12) << lookup_time(map, lookups) << std::endl;
+    _exit(0);
+}
+
+int main (int argc, char* argv[])
+{
+    if (argc < 3) {
+        std::cout << "wrong number of args. expects 2" << std::endl;
+        return 0;
+    }
+    const auto elements = std::strtoull(argv[1], nullptr, 10);
+    const auto lookup_count = std::strtoull(argv[2], nullptr, 10);
+
+    workload::rng generator(42);
+    std::vector<key_type> keys(elements);
+    for (auto & key : keys) { key = generator(); }
+    std::vector<key_type> lookups(lookup_count);
+    for (auto & key : lookups) { key = keys[generator.below(keys.size())]; }
+
+    std::cout << std::left << std::setw(28) << std::to_string(elements) + " keys" << std::right << std::setw(12) << "bytes/entry"
+              << std::setw(12) << "find ns" << std::setw(12) << "balanced" << std::endl;
+    measure<Tree<key_type, value_type>>("Tree", keys, lookups);
+    measure<CompactTree<key_type, value_type>>("CompactTree", keys, lookups);
+    measure<CompactTree<key_type, value_type, std::less<key_type>, false>>("CompactTree, no parent", keys, lookups);
+    return 0;
+}
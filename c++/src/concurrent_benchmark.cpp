@@ -0,0 +1,120 @@
+/*
+concurrent tree benchmark and stress test program
+a writer thread keeps changing a ConcurrentTree while 1, 2, 4... reader threads look up random keys.
+Every change inserts or erases two keys, key and key + offset, in the same update: readers check that
+they always see both or none of them, and that a full iteration of a snapshot is sorted and as long as size().
+Reports the read throughput for every number of readers, and the number of inconsistencies seen (must be 0)
+
+gets 3 arguments:
+1) number_of_elements in the tree
+2) max number of reader threads
+3) milliseconds of each measure
+
+example: ./concurrent_benchmark 1000000 64 1000
+
+*/
+
+#include "concurrent_tree.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using tree_type = ConcurrentTree<std::uint64_t, std::uint64_t, std::less<std::uint64_t>, balancing::avl>;
+
+struct result {
+    double lookups_per_second;
+    std::uint64_t updates;
+    std::uint64_t errors;
+};
+
+/*! lookups of random keys by readers threads for the given time, while a writer updates the tree */
+result measure(tree_type & tree, std::uint64_t elements, unsigned readers, std::chrono::milliseconds duration)
+{
+    const std::uint64_t offset = 4 * elements;
+    std::atomic<bool> stop{false};
+    std::atomic<std::uint64_t> lookups{0}, errors{0}, updates{0};
+
+    std::thread writer([&] {
+        std::mt19937_64 generator(readers);
+        while (!stop.load(std::memory_order_relaxed)) {
+            const std::uint64_t key = 2 * (generator() % elements) + 1;      // odd keys come and go
+            if (generator() % 2) {
+                tree.update([key, offset](tree_type::tree_type & t) { t.insert(key, key); t.insert(key + offset, key); });
+            } else {
+                tree.update([key, offset](tree_type::tree_type & t) { t.erase(key); t.erase(key + offset); });
+            }
+            updates.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (unsigned r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r] {
+            std::mt19937_64 generator(r + 1);
+            std::uint64_t done = 0, wrong = 0, found = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 256; ++i, ++done) {
+                    const std::uint64_t key = generator() % (2 * elements);
+                    auto snapshot = tree.read();
+                    auto it = snapshot->find(key);
+                    if (it != snapshot->end()) { found += it->second; }
+                    if (key % 2 && (it == snapshot->end()) != (snapshot->find(key + offset) == snapshot->end())) { ++wrong; }
+                }
+                if (r == 0 && done % (256 * 64) == 0) {         // now and then, a full scan
+                    auto snapshot = tree.read();
+                    std::size_t count = 0;
+                    std::uint64_t previous = 0;
+                    for (const auto & pair : *snapshot) {
+                        if (count++ && pair.first <= previous) { ++wrong; }
+                        previous = pair.first;
+                    }
+                    if (count != snapshot->size()) { ++wrong; }
+                }
+            }
+            lookups.fetch_add(done);
+            errors.fetch_add(wrong);
+            if (found == 42) { std::cout << ""; }               // keeps the lookups from being optimized away
+        });
+    }
+
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (auto & thread : threads) { thread.join(); }
+    writer.join();
+
+    const double seconds = std::chrono::duration<double>(duration).count();
+    return {static_cast<double>(lookups.load()) / seconds, updates.load(), errors.load()};
+}
+
+int main (int argc, char* argv[])
+{
+    if (argc < 4) {
+        std::cout << "wrong number of args. expects 3" << std::endl;
+        return 0;
+    }
+    const auto elements = std::strtoull(argv[1], nullptr, 10);
+    const auto max_readers = static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10));
+    const std::chrono::milliseconds duration(std::strtoull(argv[3], nullptr, 10));
+
+    Tree<std::uint64_t, std::uint64_t, std::less<std::uint64_t>, balancing::avl> initial;
+    for (std::uint64_t key = 0; key < elements; ++key) { initial.insert(initial.end(), 2 * key, 2 * key); }
+    tree_type tree(initial, max_readers + 1);
+
+    std::cout << std::left << std::setw(10) << "readers" << std::right << std::setw(16) << "Mlookup/s"
+              << std::setw(16) << "per reader" << std::setw(12) << "updates" << std::setw(10) << "errors" << std::endl;
+    std::uint64_t total_errors = 0;
+    for (unsigned readers = 1; readers <= max_readers; readers *= 2) {
+        const auto r = measure(tree, elements, readers, duration);
+        total_errors += r.errors;
+        std::cout << std::left << std::setw(10) << readers << std::right << std::setw(16) << r.lookups_per_second / 1e6
+                  << std::setw(16) << r.lookups_per_second / 1e6 / readers << std::setw(12) << r.updates
+                  << std::setw(10) << r.errors << std::endl;
+    }
+    return total_errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+/*
+lookup benchmark program
+compares find() on a balanced Tree, an AVL Tree, std::map and the FrozenTree
+obtained with Tree::freeze()
+
+gets 2 arguments:
+1) number_of_elements to put in the maps
+2) number of lookups, of random keys present in the maps
+
+example: ./frozen_benchmark 10000000 10000000
+
+*/
+
+#include "binary_tree.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+
+/*! average time of a lookup, in nanoseconds. The values found are summed, so that the lookups are not optimized away */
+template <class MapType>
+double measure(const MapType & map, const std::vector<std::uint64_t> & lookups, std::uint64_t & checksum)
+{
+    auto start = clock_type::now();
+    for (auto key : lookups) { checksum += map.find(key)->second; }
+    auto stop = clock_type::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(lookups.size());
+}
+
+int main (int argc, char* argv[])
+{
+    if (argc < 3) {
+        std::cout << "wrong number of args. expects 2" << std::endl;
+        return 0;
+    }
+    const auto elements = std::strtoull(argv[1], nullptr, 10);
+    const auto lookup_count = std::strtoull(argv[2], nullptr, 10);
+
+    std::mt19937_64 generator(42);
+    std::vector<std::uint64_t> keys(elements);
+    for (auto & key : keys) { key = generator(); }
+
+    Tree<std::uint64_t, std::uint64_t> tree;
+    Tree<std::uint64_t, std::uint64_t, std::less<std::uint64_t>, balancing::avl> avl;
+    std::map<std::uint64_t, std::uint64_t> map;
+    for (auto key : keys) {
+        tree.insert(key, key);
+        avl.insert(key, key);
+        map[key] = key;
+    }
+    tree.balance();
+    auto frozen = tree.freeze();
+
+    std::vector<std::uint64_t> lookups(lookup_count);
+    for (auto & key : lookups) { key = keys[generator() % keys.size()]; }
+
+    std::uint64_t checksum = 0;
+    std::cout << "ns per lookup, " << elements << " keys" << std::endl;
+    std::cout << std::left << std::setw(24) << "Tree after balance()" << measure(tree, lookups, checksum) << std::endl;
+    std::cout << std::left << std::setw(24) << "Tree, AVL"            << measure(avl, lookups, checksum) << std::endl;
+    std::cout << std::left << std::setw(24) << "std::map"             << measure(map, lookups, checksum) << std::endl;
+    std::cout << std::left << std::setw(24) << "FrozenTree"           << measure(frozen, lookups, checksum) << std::endl;
+    std::cout << "(checksum " << checksum << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,101 @@
+/*
+insert with hint benchmark program
+inserts nearly sorted keys, like timestamps arriving slightly out of order,
+comparing insert(key, value), which descends from the root every time,
+with insert(end(), key, value), insert_near(key, value) and std::map::emplace_hint
+
+gets 2 arguments:
+1) number_of_elements to put in the tree
+2) disorder: every key is at most this far from its sorted position
+
+example: ./hint_benchmark 1000000 16
+
+*/
+
+#include "binary_tree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+
+/*! time taken by insert_all to fill an empty map with keys, in seconds */
+template <class MapType, class Insert>
+double measure(const std::vector<std::uint64_t> & keys, Insert && insert_all)
+{
+    MapType map;
+    auto start = clock_type::now();
+    insert_all(map, keys);
+    auto stop = clock_type::now();
+    if (map.size() != keys.size()) { std::cout << "wrong size!" << std::endl; }
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+template <class MapType, class Insert>
+void report(const char * name, const std::vector<std::uint64_t> & keys, Insert && insert_all)
+{
+    const double seconds = measure<MapType>(keys, insert_all);
+    std::cout << std::left << std::setw(36) << name
+              << std::right << std::setw(14) << static_cast<double>(keys.size()) / seconds / 1e6 << std::endl;
+}
+
+/*! the four ways to fill a Tree */
+template <class TreeType>
+void report_tree(const char * name, const std::vector<std::uint64_t> & keys)
+{
+    const std::string prefix = name;
+    report<TreeType>((prefix + " insert").c_str(), keys, [](TreeType & tree, const std::vector<std::uint64_t> & all) {
+        for (auto key : all) { tree.insert(key, key); }
+    });
+    report<TreeType>((prefix + " insert(end())").c_str(), keys, [](TreeType & tree, const std::vector<std::uint64_t> & all) {
+        for (auto key : all) { tree.insert(tree.end(), key, key); }
+    });
+    report<TreeType>((prefix + " insert(previous)").c_str(), keys, [](TreeType & tree, const std::vector<std::uint64_t> & all) {
+        auto hint = tree.end();
+        for (auto key : all) { hint = tree.insert(hint, key, key); }
+    });
+    report<TreeType>((prefix + " insert_near").c_str(), keys, [](TreeType & tree, const std::vector<std::uint64_t> & all) {
+        for (auto key : all) { tree.insert_near(key, key); }
+    });
+}
+
+int main (int argc, char* argv[])
+{
+    if (argc < 3) {
+        std::cout << "wrong number of args. expects 2" << std::endl;
+        return 0;
+    }
+    const auto elements = std::strtoull(argv[1], nullptr, 10);
+    const auto disorder = std::max<std::size_t>(1, std::strtoull(argv[2], nullptr, 10));
+
+    // sorted keys, shuffled within consecutive blocks of disorder keys
+    std::mt19937_64 generator(42);
+    std::vector<std::uint64_t> keys(elements);
+    for (std::size_t i = 0; i < keys.size(); ++i) { keys[i] = 1000 * i; }
+    for (std::size_t i = 0; i < keys.size(); i += disorder) {
+        std::shuffle(keys.begin() + static_cast<std::ptrdiff_t>(i),
+                     keys.begin() + static_cast<std::ptrdiff_t>(std::min(i + disorder, keys.size())), generator);
+    }
+
+    using map_type = std::map<std::uint64_t, std::uint64_t>;
+
+    std::cout << std::left << std::setw(36) << std::to_string(elements) + " keys, disorder " + std::to_string(disorder)
+              << std::right << std::setw(14) << "insert Mop/s" << std::endl;
+    report_tree<Tree<std::uint64_t, std::uint64_t, std::less<std::uint64_t>, balancing::avl>>("avl", keys);
+    if (elements <= 100000) {        // an unbalanced tree degenerates into a list without hints: keep it small
+        report_tree<Tree<std::uint64_t, std::uint64_t>>("none", keys);
+    }
+    report<map_type>("std::map insert", keys, [](map_type & map, const std::vector<std::uint64_t> & all) {
+        for (auto key : all) { map.emplace(key, key); }
+    });
+    report<map_type>("std::map emplace_hint(end())", keys, [](map_type & map, const std::vector<std::uint64_t> & all) {
+        for (auto key : all) { map.emplace_hint(map.end(), key, key); }
+    });
+    return 0;
+}
@@ -1,33 +1,8 @@
 #include "binary_tree.h"
+#include "pool_allocator.h"
 #include <iostream>
 #include <chrono>    // benchmarking purposes
-#include <random>    // llRand, custom size_t random generator
-
-std::string random_string( size_t length ) /*!< generates a random string of given length, for benchmarking purposes */
-{
-    auto randchar = []() -> char  //neat lambda function
-    {
-        const char charset[] =
-        "0123456789"
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-        "abcdefghijklmnopqrstuvwxyz";
-        const size_t max_index = (sizeof(charset) - 1);
-        return charset[ rand() % max_index ];
-    };
-    std::string str(length,0);
-    std::generate_n( str.begin(), length, randchar );
-    return str;
-}
-
-size_t llRand()   // random number between 0 and 10^18
-{
-    std::random_device rd;              //Will be used to obtain a seed for the random number engine
-    std::mt19937 gen(rd());             //Standard mersenne_twister_engine seeded with rd()
-    std::uniform_int_distribution<size_t> dis(1, 1000000000000000);   // 1-10^15
-
-    return dis(gen);
-}
-
+#include "workload.h"  // seeded random keys and strings
 
 int main (int argc, char* argv[])
 {
@@ -53,8 +28,60 @@ int main (int argc, char* argv[])
         tree2.erase(18);
         //tree2.listNodes();
     std::cout << "\nremoveNode test completed\n";
-    //test llRand
-    //std::cout << "llRand test: --> " << llRand() << std::endl;
+
+    //test self-balancing policy: ascending keys would degenerate into a list
+        std::cout << "\nTEST AVL tree with 1023 ascending keys:\n";
+        Tree<int, int, std::less<int>, balancing::avl> avlTree;
+        for (int key = 0; key < 1023; ++key) { avlTree.insert(key, key); }
+        std::cout << "height after inserts: " << avlTree.height() << " (optimal 10)\n";
+        for (int key = 0; key < 1023; key += 2) { avlTree.erase(key); }
+        std::cout << "height after erasing even keys: " << avlTree.height() << "\n";
+
+    //test bulk load: sorted input is linked directly into a balanced tree
+        std::cout << "\nTEST bulk load of 1023 sorted pairs:\n";
+        std::vector<std::pair<int, std::string>> sortedPairs;
+        for (int key = 0; key < 1023; ++key) { sortedPairs.emplace_back(key, std::to_string(key)); }
+        Tree<int, std::string> bulkTree(std::make_move_iterator(sortedPairs.begin()),
+                                        std::make_move_iterator(sortedPairs.end()));
+        std::cout << "size " << bulkTree.size() << ", height " << bulkTree.height() << " (optimal 10)\n";
+        Tree<int, std::string> listTree{{3, "c"}, {1, "a"}, {2, "b"}};
+        std::cout << listTree;
+
+    //test range queries and order statistics
+        std::cout << "\nTEST rank and select on 1000 keys 0, 2, 4...:\n";
+        Tree<int, int, std::less<int>, balancing::ranked_avl> rankedTree;
+        for (int key = 0; key < 2000; key += 2) { rankedTree.insert(key, key); }
+        std::cout << "rank(501) " << rankedTree.rank(501) << ", select(250) " << rankedTree.select(250)->first
+                  << ", keys in [100, 200) " << rankedTree.count_range(100, 200)
+                  << ", lower_bound(501) " << rankedTree.lower_bound(501)->first
+                  << ", last key " << rankedTree.rbegin()->first << "\n";
+    //test instrumentation
+        std::cout << "\nTEST stats of 1000 lookups before and after balance, keys inserted in order:\n";
+        Tree<int, int, std::less<int>, balancing::none, std::allocator<std::pair<const int, int>>, instrument::counting> countedTree;
+        for (int key = 0; key < 1000; ++key) { countedTree.insert(key, key); }
+        for (int key = 0; key < 1000; ++key) { countedTree.find(key); }
+        std::cout << countedTree.stats();
+        countedTree.balance();
+        countedTree.reset_stats();
+        for (int key = 0; key < 1000; ++key) { countedTree.find(key); }
+        countedTree.stats().write_json(std::cout);
+        std::cout << "\n";
+
+    //test two trees sharing one pool: clearing one must not free the nodes of the other
+        std::cout << "\nTEST two trees built from the same pool_allocator:\n";
+        {
+            pool_allocator<std::pair<const int, std::string>> pool;
+            using pooled_tree = Tree<int, std::string, std::less<int>, balancing::none, pool_allocator<std::pair<const int, std::string>>>;
+            pooled_tree first(std::less<int>(), pool), second(std::less<int>(), pool);
+            for (int key = 0; key < 1000; ++key) {
+                first.insert(key, std::to_string(key));
+                second.insert(key, "value " + std::to_string(key));
+            }
+            first.clear();
+            std::size_t intact = 0;
+            for (int key = 0; key < 1000; ++key) { intact += second.find(key)->second == "value " + std::to_string(key); }
+            std::cout << "after clearing the first tree the second still has " << intact << " of 1000 values\n";
+        }
 
     //read iterations and string length from argv
     const  int iterations = std::atoi(argv[1]);
@@ -62,6 +89,9 @@ int main (int argc, char* argv[])
     const  int readtoo    = std::atoi(argv[3]);
     std::string dummy_value = "";
 
+    //keys and values of the same run are the same every time
+    workload::rng generator(42);
+
     //create an empty tree
     Tree <size_t,std::string> myMap;
 
@@ -70,8 +100,8 @@ int main (int argc, char* argv[])
     //populate the map
     for (int counter = 0; counter < iterations; ++counter )
     {
-        size_t index = llRand();
-        auto value = random_string(str_length);
+        size_t index = generator.below(1000000000000000) + 1;     // 1-10^15
+        auto value = workload::random_string(static_cast<size_t>(str_length), generator);
         myMap.insert(index, value);
     }
 
@@ -86,29 +116,30 @@ int main (int argc, char* argv[])
           std::cout << "My tree: \n ---------- \n" << myMap << std::endl;
     }
 
-    // lookup time before balance:
+    // lookup time before balance: a single lookup, see benchmark for proper measures
 
     std::cout << "looking for my droids before tree balance... " ;
-    auto start_time = std::chrono::high_resolution_clock::now();
-    std::cout << myMap.find(testKey)->second << std::endl;
-    auto end_time = std::chrono::high_resolution_clock::now();
+    auto start_time = std::chrono::steady_clock::now();
+    auto found = myMap.find(testKey);
+    auto end_time = std::chrono::steady_clock::now();
+    std::cout << found->second << std::endl;
     std::cout << "The droids found with a lookup time of "  ;
     std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count() << " nanosec" << std::endl;
 
 
     //test
     //auto v = myMap.arrayOfNodes();
-    std::cout << "Tree height before balance: " << myMap.height << std::endl;
+    std::cout << "Tree height before balance: " << myMap.height() << std::endl;
     myMap.balance();
-    std::cout << "Tree height after balance: " << myMap.height << std::endl;
+    std::cout << "Tree height after balance: " << myMap.height() << std::endl;
 
     // benchmark for lookup time after balance
 
     std::cout << "looking for my droids after balance... " ;
-    //std::cout << std::chrono::high_resolution_clock::period::den << std::endl;
-    auto start_time2 = std::chrono::high_resolution_clock::now();
-    std::cout << myMap.find(testKey)->second << std::endl;
-    auto end_time2 = std::chrono::high_resolution_clock::now();
+    auto start_time2 = std::chrono::steady_clock::now();
+    found = myMap.find(testKey);
+    auto end_time2 = std::chrono::steady_clock::now();
+    std::cout << found->second << std::endl;
     std::cout << "The droids found with a lookup time of "  ;
     std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(end_time2 - start_time2).count() << " nanoseconds" << std::endl;
 
@@ -116,8 +147,13 @@ int main (int argc, char* argv[])
     
     auto tree3(myMap);
     
-    std::cout << tree3 << " --- \n" << tree3.height;
+    std::cout << tree3 << " --- \n" << tree3.height();
     tree3.balance();
-    std::cout << "balanced : " << tree3.height << std::endl;
+    std::cout << "balanced : " << tree3.height() << std::endl;
+
+    Tree <size_t,std::string> tree4;
+    tree4 = tree3;
+    tree3.clear();
+    std::cout << "copy assigned: " << tree4.size() << " nodes, height " << tree4.height() << std::endl;
   return 0;
 }
@@ -5,7 +5,7 @@ gets always 3 arguments:
 2) length of string elements 
 3) readtoo?(0/1) 0 = only populates the map, 1 = also read the values
 
-COMPILE WITH -O0 to avoid optimization!
+times a single lookup, see benchmark for proper measures
 
 example
 
@@ -15,35 +15,7 @@ example
 #include <map>
 #include <algorithm>
 #include <chrono>
-#include <random>
-
-/*!< generates a random string of given length */
-std::string random_string( size_t length )
-{
-    auto randchar = []() -> char
-    {
-        const char charset[] =
-        "0123456789"
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-        "abcdefghijklmnopqrstuvwxyz";
-        const size_t max_index = (sizeof(charset) - 1);
-        return charset[ rand() % max_index ];
-    };
-    std::string str(length,0);
-    std::generate_n( str.begin(), length, randchar );
-    return str;
-}
-
-size_t llRand()   // random number between 0 and 10^18
-{
-    std::random_device rd;              //Will be used to obtain a seed for the random number engine
-    std::mt19937 gen(rd());             //Standard mersenne_twister_engine seeded with rd()
-    std::uniform_int_distribution<size_t> dis(1, 1000000000000000);   // 1-10^15
-
-    return dis(gen);
-}
-
-
+#include "workload.h"  // seeded random keys and strings
 
 int main (int argc, char* argv[])
 {
@@ -52,8 +24,8 @@ int main (int argc, char* argv[])
         std::cout << "wrong number of args. expects 3" << std::endl;
         return 0;}
 
-	// initialize random seed
-	srand (static_cast<unsigned>(time(NULL)));
+	// keys and values of the same run are the same every time, and the same as in tree
+	workload::rng generator(42);
 
 	//read iterations and string length from argv
 	const  int iterations = std::atoi(argv[1]);
@@ -67,22 +39,22 @@ int main (int argc, char* argv[])
   	//populate the map
   	for (int counter = 0; counter < iterations; ++counter ) 
   	{
-  		size_t index = llRand();
-        auto value = random_string(str_length);
+  		size_t index = generator.below(1000000000000000) + 1;     // 1-10^15
+        auto value = workload::random_string(static_cast<size_t>(str_length), generator);
         myMap[index] = value;
   	}
   
   	std::cout << "Map populated with " << iterations << " elements." << std::endl;
 
-    // benchmark for lookup time after balance
+    // lookup time
     
     size_t testKey = 424242424242424242;
 
-    std::cout << "looking for my droids after balance... " ;
-    //std::cout << std::chrono::high_resolution_clock::period::den << std::endl;
-    auto start_time2 = std::chrono::high_resolution_clock::now();
-    std::cout << myMap[testKey] << std::endl;
-    auto end_time2 = std::chrono::high_resolution_clock::now();
+    std::cout << "looking for my droids... " ;
+    auto start_time2 = std::chrono::steady_clock::now();
+    auto found = myMap.find(testKey);
+    auto end_time2 = std::chrono::steady_clock::now();
+    std::cout << (found != myMap.end() ? found->second : "not found") << std::endl;
     std::cout << "The droids found with a lookup time of "  ;
     std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(end_time2 - start_time2).count() << " nanoseconds" << std::endl;
 
@@ -0,0 +1,94 @@
+/*
+parallel build benchmark program
+compares the serial and parallel versions of the bulk load of unsorted pairs,
+insert(first, last) and insert(pool, first, last), of balance() and balance(pool)
+on a tree filled by random inserts, and a full read of the tree, as the readtoo option of main.cpp:
+an iteration summing the values against parallel_reduce, and parallel_count_if
+
+gets 2 arguments:
+1) number_of_elements to put in the tree
+2) number of threads of the pool
+
+example: ./parallel_benchmark 10000000 8
+
+*/
+
+#include "binary_tree.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+using tree_type = Tree<std::uint64_t, std::uint64_t>;
+
+/*! seconds taken by f */
+template <class F>
+double seconds(F && f)
+{
+    auto start = clock_type::now();
+    f();
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+void report(const char * name, double serial, double parallel)
+{
+    std::cout << std::left << std::setw(20) << name << std::right << std::setw(12) << serial
+              << std::setw(12) << parallel << std::setw(12) << serial / parallel << std::endl;
+}
+
+int main (int argc, char* argv[])
+{
+    if (argc < 3) {
+        std::cout << "wrong number of args. expects 2" << std::endl;
+        return 0;
+    }
+    const auto elements = std::strtoull(argv[1], nullptr, 10);
+    thread_pool pool(static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)));
+
+    std::mt19937_64 generator(42);
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> pairs(elements);
+    for (auto & pair : pairs) { pair.first = pair.second = generator(); }
+
+    std::cout << std::left << std::setw(20) << std::to_string(elements) + " keys" << std::right << std::setw(12) << "serial s"
+              << std::setw(12) << std::to_string(pool.size()) + " threads" << std::setw(12) << "speedup" << std::endl;
+
+    double serial, parallel;
+    {
+        tree_type tree;
+        serial = seconds([&] { tree.insert(pairs.begin(), pairs.end()); });
+    }
+    {
+        tree_type tree;
+        parallel = seconds([&] { tree.insert(pool, pairs.begin(), pairs.end()); });
+    }
+    report("bulk load", serial, parallel);
+
+    tree_type tree;
+    for (const auto & pair : pairs) { tree.insert(pair.first, pair.second); }
+    tree_type first(tree), second(tree);            // same memory layout for both
+    serial = seconds([&] { first.balance(); });
+    parallel = seconds([&] { second.balance(pool); });
+    report("balance", serial, parallel);
+
+    std::uint64_t sum = 0, parallel_sum = 0;
+    serial = seconds([&] { for (const auto & pair : first) { sum += pair.second; } });
+    parallel = seconds([&] {
+        parallel_sum = first.parallel_reduce(pool, std::uint64_t{0}, std::plus<std::uint64_t>(),
+                                             [](const auto & pair) { return pair.second; });
+    });
+    report("full read", serial, parallel);
+    if (sum != parallel_sum) { std::cout << "wrong sum!" << std::endl; }
+
+    std::size_t odd = 0, parallel_odd = 0;
+    auto is_odd = [](const auto & pair) { return pair.second % 2 == 1; };
+    serial = seconds([&] { for (const auto & pair : first) { odd += is_odd(pair); } });
+    parallel = seconds([&] { parallel_odd = first.parallel_count_if(pool, is_odd); });
+    report("count_if", serial, parallel);
+    if (odd != parallel_odd) { std::cout << "wrong count!" << std::endl; }
+    return 0;
+}
@@ -0,0 +1,79 @@
+/*
+node allocation benchmark program
+compares the insert and clear throughput of a Tree using std::allocator
+(one new/delete per node, as the previous std::unique_ptr<Node> layout did)
+with the same Tree using pool_allocator
+
+gets 2 arguments:
+1) number_of_elements to put in the tree
+2) repetitions of each measure (the best one is reported)
+
+example: ./pool_benchmark 10000000 3
+
+*/
+
+#include "binary_tree.h"
+#include "pool_allocator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+
+/*! best insert and clear time, in seconds, over the given number of repetitions */
+template <class TreeType>
+std::pair<double, double> measure(const std::vector<std::uint64_t> & keys, int repetitions)
+{
+    double best_insert = 1e300, best_clear = 1e300;
+    TreeType tree;
+    for (int rep = 0; rep < repetitions; ++rep) {
+        auto start = clock_type::now();
+        for (auto key : keys) { tree.insert(key, key); }
+        auto inserted = clock_type::now();
+        tree.clear();
+        auto cleared = clock_type::now();
+
+        best_insert = std::min(best_insert, std::chrono::duration<double>(inserted - start).count());
+        best_clear  = std::min(best_clear,  std::chrono::duration<double>(cleared - inserted).count());
+    }
+    return {best_insert, best_clear};
+}
+
+template <class TreeType>
+void report(const char * name, const std::vector<std::uint64_t> & keys, int repetitions)
+{
+    auto times = measure<TreeType>(keys, repetitions);
+    const double n = static_cast<double>(keys.size());
+    std::cout << std::left << std::setw(28) << name
+              << std::right << std::setw(14) << n / times.first / 1e6
+              << std::setw(14) << n / times.second / 1e6 << std::endl;
+}
+
+int main (int argc, char* argv[])
+{
+    if (argc < 3) {
+        std::cout << "wrong number of args. expects 2" << std::endl;
+        return 0;
+    }
+    const auto elements = std::strtoull(argv[1], nullptr, 10);
+    const int repetitions = std::atoi(argv[2]);
+
+    std::mt19937_64 generator(42);
+    std::vector<std::uint64_t> keys(elements);
+    for (auto & key : keys) { key = generator(); }
+
+    using value_type = std::pair<const std::uint64_t, std::uint64_t>;
+
+    std::cout << std::left << std::setw(28) << "tree (" + std::to_string(elements) + " keys)"
+              << std::right << std::setw(14) << "insert Mop/s" << std::setw(14) << "clear Mop/s" << std::endl;
+    report<Tree<std::uint64_t, std::uint64_t, std::less<std::uint64_t>, balancing::none>>("std::allocator", keys, repetitions);
+    report<Tree<std::uint64_t, std::uint64_t, std::less<std::uint64_t>, balancing::none, pool_allocator<value_type>>>("pool_allocator", keys, repetitions);
+    report<Tree<std::uint64_t, std::uint64_t, std::less<std::uint64_t>, balancing::avl>>("avl, std::allocator", keys, repetitions);
+    report<Tree<std::uint64_t, std::uint64_t, std::less<std::uint64_t>, balancing::avl, pool_allocator<value_type>>>("avl, pool_allocator", keys, repetitions);
+    return 0;
+}
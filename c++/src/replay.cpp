@@ -0,0 +1,105 @@
+/*
+trace record and replay program
+generate writes a binary trace (see workload.h) of finds, inserts and erases with keys of a given distribution;
+run replays a trace, generated or captured elsewhere, on an empty Tree, an empty AVL Tree and an empty std::map,
+reporting the time taken by each and a checksum of the results, which must be the same for all
+
+generate gets 7 arguments, and an optional eighth:
+1) output trace file
+2) distribution: uniform, zipf, sorted, reverse_sorted, clustered, hot_set
+3) key space: keys are in [0, key_space)
+4) number of operations
+5-7) weights of finds, inserts and erases
+8) seed, 42 by default
+
+run gets 1 argument: the trace file
+
+example: ./replay generate zipf.trace zipf 1000000 10000000 90 9 1
+         ./replay run zipf.trace
+
+*/
+
+#include "binary_tree.h"
+#include "workload.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+using key_type = std::uint64_t;
+
+/*! replays trace on an empty map, printing time and checksum: the sum of the values found, and the final size */
+template <class MapType>
+void replay(const char * name, const std::vector<workload::request> & trace)
+{
+    MapType map;
+    std::uint64_t checksum = 0;
+    const auto start = clock_type::now();
+    for (const auto & item : trace) {
+        switch (item.kind) {
+            case workload::op::find: {
+                auto it = map.find(item.key);
+                if (it != map.end()) { checksum += it->second; }
+                break;
+            }
+            case workload::op::insert: map.insert_or_assign(item.key, item.key); break;
+            case workload::op::erase: map.erase(item.key); break;
+        }
+    }
+    const double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+    std::cout << std::left << std::setw(12) << name << std::right << std::setw(12) << seconds
+              << std::setw(12) << static_cast<double>(trace.size()) / seconds / 1e6
+              << std::setw(24) << checksum + map.size() << std::endl;
+}
+
+int main (int argc, char* argv[])
+{
+    const std::string command = argc > 1 ? argv[1] : "";
+    if (command == "generate" && argc >= 9) {
+        workload::distribution kind;
+        if (!workload::parse(argv[3], kind)) {
+            std::cout << "unknown distribution " << argv[3] << std::endl;
+            return 1;
+        }
+        const auto key_space = std::strtoull(argv[4], nullptr, 10);
+        const auto count = std::strtoull(argv[5], nullptr, 10);
+        const workload::mix weights{static_cast<unsigned>(std::strtoul(argv[6], nullptr, 10)),
+                                    static_cast<unsigned>(std::strtoul(argv[7], nullptr, 10)),
+                                    static_cast<unsigned>(std::strtoul(argv[8], nullptr, 10))};
+        const auto seed = argc > 9 ? std::strtoull(argv[9], nullptr, 10) : 42ULL;
+
+        workload::key_generator keys(kind, key_space, seed);
+        workload::rng generator(seed + 1);
+        std::ofstream out(argv[2], std::ios::binary);
+        if (!workload::write_trace(out, workload::make_trace(keys, weights, count, generator))) {
+            std::cout << "cannot write " << argv[2] << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (command == "run" && argc >= 3) {
+        std::ifstream in(argv[2], std::ios::binary);
+        std::vector<workload::request> trace;
+        if (!workload::read_trace(in, trace)) {
+            std::cout << argv[2] << " is not a valid trace" << std::endl;
+            return 1;
+        }
+        std::cout << trace.size() << " operations" << std::endl;
+        std::cout << std::left << std::setw(12) << "" << std::right << std::setw(12) << "seconds"
+                  << std::setw(12) << "Mop/s" << std::setw(24) << "checksum" << std::endl;
+        replay<Tree<key_type, key_type>>("Tree", trace);
+        replay<Tree<key_type, key_type, std::less<key_type>, balancing::avl>>("Tree avl", trace);
+        replay<std::map<key_type, key_type>>("std::map", trace);
+        return 0;
+    }
+    std::cout << "usage: replay generate file distribution key_space operations finds inserts erases [seed]\n"
+                 "       replay run file" << std::endl;
+    return 0;
+}
@@ -0,0 +1,117 @@
+/*
+sharded tree benchmark program
+1, 2, 4... threads run a mix of find, insert and erase of random keys on
+a ShardedTree, a Tree guarded by one mutex and a std::map guarded by one mutex,
+reporting the total throughput
+
+gets 4 arguments:
+1) range of the keys; the maps start half full
+2) max number of threads
+3) percentage of lookups, the rest is split evenly between inserts and erases
+4) milliseconds of each measure
+
+example: ./sharded_benchmark 1000000 64 50 1000
+
+*/
+
+#include "sharded_tree.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+/*! any map with insert, erase and find, behind a single mutex */
+template <class MapType>
+class locked {
+    std::mutex lock;
+    MapType map;
+public:
+    void insert(std::uint64_t key, std::uint64_t value) {
+        std::lock_guard<std::mutex> guard(lock);
+        map.insert_or_assign(key, value);
+    }
+    void erase(std::uint64_t key) {
+        std::lock_guard<std::mutex> guard(lock);
+        map.erase(key);
+    }
+    bool contains(std::uint64_t key) {
+        std::lock_guard<std::mutex> guard(lock);
+        return map.find(key) != map.end();
+    }
+};
+
+/*! millions of operations per second of threads running the mix for the given time on a fresh map */
+template <class MapType>
+double measure(std::uint64_t range, unsigned threads, unsigned lookup_percent, std::chrono::milliseconds duration)
+{
+    MapType map;
+    std::mt19937_64 generator(42);
+    for (std::uint64_t i = 0; i < range / 2; ++i) {
+        const auto key = generator() % range;
+        map.insert(key, key);
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<std::uint64_t> operations{0};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937_64 local(t + 1);
+            std::uint64_t done = 0, found = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 256; ++i, ++done) {
+                    const auto key = local() % range;
+                    const auto dice = static_cast<unsigned>(local() % 200);
+                    if (dice < 2 * lookup_percent) {
+                        found += map.contains(key);
+                    } else if (dice % 2) {
+                        map.insert(key, key);
+                    } else {
+                        map.erase(key);
+                    }
+                }
+            }
+            operations.fetch_add(done);
+            if (found == 42) { std::cout << ""; }       // keeps the lookups from being optimized away
+        });
+    }
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (auto & worker : workers) { worker.join(); }
+    return static_cast<double>(operations.load()) / std::chrono::duration<double>(duration).count() / 1e6;
+}
+
+int main (int argc, char* argv[])
+{
+    if (argc < 5) {
+        std::cout << "wrong number of args. expects 4" << std::endl;
+        return 0;
+    }
+    const auto range = std::strtoull(argv[1], nullptr, 10);
+    const auto max_threads = static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10));
+    const auto lookup_percent = static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10));
+    const std::chrono::milliseconds duration(std::strtoull(argv[4], nullptr, 10));
+
+    using key_type = std::uint64_t;
+    using sharded = ShardedTree<key_type, key_type, 64, std::less<key_type>, balancing::avl>;
+    using tree = locked<Tree<key_type, key_type, std::less<key_type>, balancing::avl>>;
+    using map = locked<std::map<key_type, key_type>>;
+
+    std::cout << "Mop/s, " << range << " keys, " << lookup_percent << "% lookups" << std::endl;
+    std::cout << std::left << std::setw(10) << "threads" << std::right << std::setw(16) << "ShardedTree<64>"
+              << std::setw(16) << "mutex + Tree" << std::setw(16) << "mutex + map" << std::endl;
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        std::cout << std::left << std::setw(10) << threads << std::right
+                  << std::setw(16) << measure<sharded>(range, threads, lookup_percent, duration)
+                  << std::setw(16) << measure<tree>(range, threads, lookup_percent, duration)
+                  << std::setw(16) << measure<map>(range, threads, lookup_percent, duration) << std::endl;
+    }
+    return 0;
+}
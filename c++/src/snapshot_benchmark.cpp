@@ -0,0 +1,74 @@
+/*
+snapshot benchmark program
+compares the ways of getting a Tree back after a restart: inserting every pair again, load() of a snapshot
+written by save(), and mapping the snapshot with MappedTree, whose first lookups read the pages from disk
+
+gets 2 arguments:
+1) number_of_elements in the tree
+2) path of the snapshot file to write
+
+example: ./snapshot_benchmark 10000000 /tmp/tree.snap
+
+*/
+
+#include "binary_tree.h"
+#include "mapped_tree.h"
+#include "workload.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+using tree_type = Tree<std::uint64_t, std::uint64_t, std::less<std::uint64_t>, balancing::avl>;
+
+/*! seconds taken by f */
+template <class F>
+double seconds(F && f)
+{
+    auto start = clock_type::now();
+    f();
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+void report(const char * name, double time)
+{
+    std::cout << std::left << std::setw(28) << name << std::right << std::setw(12) << time << std::endl;
+}
+
+int main (int argc, char* argv[])
+{
+    if (argc < 3) {
+        std::cout << "wrong number of args. expects 2" << std::endl;
+        return 0;
+    }
+    const auto elements = std::strtoull(argv[1], nullptr, 10);
+    const std::string path = argv[2];
+
+    workload::rng generator(42);
+    std::vector<std::uint64_t> keys(elements);
+    for (auto & key : keys) { key = generator(); }
+
+    std::cout << std::left << std::setw(28) << std::to_string(elements) + " keys" << std::right << std::setw(12) << "seconds" << std::endl;
+    tree_type tree;
+    report("insert every key", seconds([&] { for (auto key : keys) { tree.insert(key, key); } }));
+    report("save", seconds([&] { tree.save(path); }));
+
+    tree_type loaded;
+    report("load", seconds([&] { loaded.load(path); }));
+
+    MappedTree<std::uint64_t, std::uint64_t> mapped;
+    report("MappedTree open", seconds([&] { mapped.open(path); }));
+    std::uint64_t checksum = 0;
+    const std::size_t lookups = std::min<std::size_t>(keys.size(), 1000000);
+    report("MappedTree 10^6 find", seconds([&] {
+        for (std::size_t i = 0; i < lookups; ++i) { checksum += mapped.find(keys[generator.below(keys.size())])->second; }
+    }));
+    report("loaded Tree 10^6 find", seconds([&] {
+        for (std::size_t i = 0; i < lookups; ++i) { checksum += loaded.find(keys[generator.below(keys.size())])->second; }
+    }));
+    std::cout << "(" << loaded.size() << " pairs loaded, " << mapped.size() << " mapped, checksum " << checksum << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,78 @@
+/*
+static table benchmark program
+a lookup table of 64 sparse integer codes, as opcode to handler or error code to message: StaticTree, built by
+the compiler, against a Tree filled at startup by insert and its FrozenTree. Prints the time taken to build
+the Tree, which StaticTree does not pay, and the ns per lookup of each
+
+gets 1 argument: number of lookups
+
+example: ./static_benchmark 10000000
+
+*/
+
+#include "binary_tree.h"
+#include "static_tree.h"
+#include "workload.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::size_t entries = 64;
+
+/*! the code of entry i: sparse, and not in order */
+constexpr std::uint32_t code(std::size_t i) { return static_cast<std::uint32_t>((i * 2654435761u) % 100000u); }
+
+constexpr auto table = [] {
+    std::pair<std::uint32_t, std::uint32_t> pairs[entries] {};
+    for (std::size_t i = 0; i < entries; ++i) {
+        pairs[i].first = code(i);
+        pairs[i].second = static_cast<std::uint32_t>(i);
+    }
+    return make_static_tree(pairs);
+}();
+
+static_assert(table.find(code(42))->second == 42, "built at compile time");
+
+/*! ns per lookup of every code in codes, and the sum of the values found */
+template <class MapType>
+void report(const char * name, const MapType & map, const std::vector<std::uint32_t> & codes)
+{
+    std::uint64_t checksum = 0;
+    const auto start = clock_type::now();
+    for (auto key : codes) { checksum += map.find(key)->second; }
+    const double ns = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+    std::cout << std::left << std::setw(16) << name << std::right << std::setw(12) << ns / static_cast<double>(codes.size())
+              << std::setw(16) << checksum << std::endl;
+}
+
+int main (int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cout << "wrong number of args. expects 1" << std::endl;
+        return 0;
+    }
+    const auto lookups = std::strtoull(argv[1], nullptr, 10);
+
+    const auto start = clock_type::now();
+    Tree<std::uint32_t, std::uint32_t, std::less<std::uint32_t>, balancing::avl> tree;
+    for (std::size_t i = 0; i < entries; ++i) { tree.insert(code(i), static_cast<std::uint32_t>(i)); }
+    const double build = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+    const auto frozen = tree.freeze();
+
+    workload::rng generator(42);
+    std::vector<std::uint32_t> codes(lookups);
+    for (auto & key : codes) { key = code(generator.below(entries)); }
+
+    std::cout << "Tree built at startup in " << build << " ns, StaticTree in 0" << std::endl;
+    std::cout << std::left << std::setw(16) << "ns per lookup" << std::right << std::setw(12) << "find"
+              << std::setw(16) << "checksum" << std::endl;
+    report("StaticTree", table, codes);
+    report("FrozenTree", frozen, codes);
+    report("Tree avl", tree, codes);
+    return 0;
+}
@@ -0,0 +1,80 @@
+/*
+string keys benchmark program
+the workload of main.cpp with keys and values swapped: random strings from workload::random_string() as keys,
+integers as values. Compares Tree, which keeps the prefix of every std::string key in its nodes
+(see key_prefix.h), the same Tree with a comparator that disables the prefixes, and std::map
+
+gets 2 arguments, and an optional third:
+1) number_of_elements in the tree
+2) length of the random part of the keys
+3) length of a prefix shared by all the keys, 0 by default: with 7 or more every prefix ties,
+   and the keys are always compared in full
+
+example: ./string_benchmark 1000000 16
+         ./string_benchmark 1000000 16 8
+
+*/
+
+#include "binary_tree.h"
+#include "workload.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+
+/*! std::less<std::string> under another name, so that Tree keeps no prefix */
+struct plain_less {
+    bool operator()(const std::string & lhs, const std::string & rhs) const { return lhs < rhs; }
+};
+
+/*! ns per key to insert every key in an empty map, then to find them all in another order */
+template <class MapType>
+void report(const char * name, const std::vector<std::string> & keys, const std::vector<std::string> & lookups)
+{
+    MapType map;
+    auto start = clock_type::now();
+    for (std::size_t i = 0; i < keys.size(); ++i) { map.insert_or_assign(keys[i], i); }
+    const double insert = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+
+    std::size_t checksum = 0;
+    start = clock_type::now();
+    for (const auto & key : lookups) { checksum += map.find(key)->second; }
+    const double find = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+
+    std::cout << std::left << std::setw(20) << name << std::right
+              << std::setw(12) << insert / static_cast<double>(keys.size())
+              << std::setw(12) << find / static_cast<double>(lookups.size())
+              << std::setw(20) << checksum << std::endl;
+}
+
+int main (int argc, char* argv[])
+{
+    if (argc < 3) {
+        std::cout << "wrong number of args. expects 2 or 3" << std::endl;
+        return 0;
+    }
+    const auto elements = std::strtoull(argv[1], nullptr, 10);
+    const auto length = std::strtoull(argv[2], nullptr, 10);
+    const auto shared = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 0ULL;
+
+    workload::rng generator(42);
+    const std::string common(shared, '/');
+    std::vector<std::string> keys(elements);
+    for (auto & key : keys) { key = common + workload::random_string(length, generator); }
+    std::vector<std::string> lookups(keys.size());
+    for (auto & key : lookups) { key = keys[generator.below(keys.size())]; }
+
+    std::cout << elements << " keys of " << shared + length << " bytes, " << shared << " shared" << std::endl;
+    std::cout << std::left << std::setw(20) << "ns per key" << std::right << std::setw(12) << "insert"
+              << std::setw(12) << "find" << std::setw(20) << "checksum" << std::endl;
+    report<Tree<std::string, std::size_t, std::less<std::string>, balancing::avl>>("Tree prefix", keys, lookups);
+    report<Tree<std::string, std::size_t, plain_less, balancing::avl>>("Tree no prefix", keys, lookups);
+    report<std::map<std::string, std::size_t>>("std::map", keys, lookups);
+    return 0;
+}
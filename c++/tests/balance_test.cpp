@@ -0,0 +1,121 @@
+/*
+balance test
+balance() relinks the nodes of trees of every balancing policy, built from workload traces and from sorted
+keys, in a tree of minimum height: the pairs are the same as in std::map, the nodes are the same objects,
+and the tree keeps working after it; covers the empty tree and a single node
+*/
+
+#include "binary_tree.h"
+#include "test.h"
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+
+using key_type = std::uint64_t;
+
+template <class Balance>
+using tree_type = Tree<key_type, std::string, std::less<key_type>, Balance>;
+
+/*! levels of a tree of minimum height holding count nodes */
+std::size_t minimum_height(std::size_t count)
+{
+    std::size_t levels = 0;
+    while (count >> levels) { ++levels; }
+    return levels;
+}
+
+/*! addresses of the nodes of tree */
+template <class TreeType>
+std::set<const void *> nodes_of(TreeType & tree)
+{
+    std::set<const void *> nodes;
+    for (auto it = tree.begin(); it != tree.end(); ++it) { nodes.insert(it.get_node()); }
+    return nodes;
+}
+
+/*! balances tree, holding the pairs of reference, and checks it */
+template <class TreeType>
+void check_balance(TreeType & tree, std::map<key_type, std::string> & reference)
+{
+    const auto before = nodes_of(tree);
+    tree.balance();
+    CHECK(test::valid(tree));
+    CHECK(tree.height() == minimum_height(tree.size()));
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(nodes_of(tree) == before);                 // relinked, not copied
+
+    for (key_type key = 0; key < 100; ++key) {       // inserts and erases after the nodes moved
+        tree.insert(key * 7, std::to_string(key));
+        reference[key * 7] = std::to_string(key);
+        tree.erase(key * 11);
+        reference.erase(key * 11);
+    }
+    CHECK(test::valid(tree));
+    CHECK(test::same_pairs(tree, reference));
+}
+
+template <class Balance>
+void small_trees()
+{
+    tree_type<Balance> tree;
+    tree.balance();
+    CHECK(tree.empty());
+    CHECK(test::valid(tree));
+    tree.insert(5, "five");
+    tree.balance();
+    CHECK(tree.height() == 1);
+    CHECK(tree.find(5)->second == "five");
+    CHECK(test::valid(tree));
+}
+
+template <class Balance>
+void from_trace(workload::distribution d)
+{
+    tree_type<Balance> tree;
+    std::map<key_type, std::string> reference;
+    for (const auto & request : test::trace(d, 4000, 20000, {0, 3, 1})) {
+        if (request.kind == workload::op::insert) {
+            tree.insert(request.key, std::to_string(request.key));
+            reference[request.key] = std::to_string(request.key);
+        } else {
+            tree.erase(request.key);
+            reference.erase(request.key);
+        }
+    }
+    check_balance(tree, reference);
+}
+
+/*! sorted keys: a plain tree degenerates into a list, which balance() folds */
+template <class Balance>
+void from_sorted(std::size_t count)
+{
+    tree_type<Balance> tree;
+    std::map<key_type, std::string> reference;
+    for (key_type key = 0; key < count; ++key) {
+        tree.insert(tree.end(), key, std::to_string(key));
+        reference[key] = std::to_string(key);
+    }
+    check_balance(tree, reference);
+}
+
+template <class Balance>
+void all(const char * name)
+{
+    std::cout << name << std::endl;
+    small_trees<Balance>();
+    for (auto d : {workload::distribution::uniform, workload::distribution::zipf, workload::distribution::clustered}) {
+        from_trace<Balance>(d);
+    }
+    for (std::size_t count : {2, 3, 7, 8, 1000, 4095, 4096}) { from_sorted<Balance>(count); }
+}
+
+int main()
+{
+    all<balancing::none>("none");
+    all<balancing::avl>("avl");
+    all<balancing::ranked>("ranked");
+    all<balancing::ranked_avl>("ranked_avl");
+    return test::result();
+}
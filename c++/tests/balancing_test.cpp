@@ -0,0 +1,129 @@
+/*
+balancing policies test
+replays workload traces on Tree with every balancing policy and on std::map, checking that they hold the same
+pairs and that the links and bookkeeping of the nodes stay consistent; covers the empty tree, a single node,
+duplicate keys and erasing the root, and the height bound of AVL trees on sorted input
+*/
+
+#include "binary_tree.h"
+#include "test.h"
+
+#include <cmath>
+#include <cstdint>
+#include <map>
+
+using key_type = std::uint64_t;
+
+template <class Balance>
+using tree_type = Tree<key_type, std::size_t, std::less<key_type>, Balance>;
+
+template <class Balance>
+void empty_tree()
+{
+    tree_type<Balance> tree;
+    CHECK(tree.empty());
+    CHECK(tree.begin() == tree.end());
+    CHECK(tree.find(1) == tree.end());
+    tree.erase(1);
+    CHECK(test::valid(tree));
+    CHECK(tree.height() == 0);
+}
+
+template <class Balance>
+void single_node()
+{
+    tree_type<Balance> tree;
+    tree.insert(7, 1);
+    CHECK(tree.size() == 1);
+    CHECK(test::valid(tree));
+    CHECK(tree.find(7)->second == 1);
+    CHECK(tree.find(6) == tree.end());
+    tree.erase(7);
+    CHECK(tree.empty());
+    CHECK(test::valid(tree));
+}
+
+template <class Balance>
+void duplicate_keys()
+{
+    tree_type<Balance> tree;
+    CHECK(tree.insert(3, 1).second);
+    CHECK(!tree.insert(3, 2).second);
+    CHECK(tree.size() == 1);
+    CHECK(tree.find(3)->second == 2);
+    CHECK(test::valid(tree));
+}
+
+/*! erases the key at the root until the tree is empty, checking the tree after every erase */
+template <class Balance>
+void erase_root()
+{
+    tree_type<Balance> tree;
+    std::map<key_type, std::size_t> reference;
+    workload::rng generator(7);
+    for (std::size_t i = 0; i < 500; ++i) {
+        const key_type key = generator.below(1000);
+        tree.insert(key, i);
+        reference[key] = i;
+    }
+    bool consistent = true;
+    while (!tree.empty() && consistent) {
+        auto root = tree.begin().get_node();
+        while (root->parent) { root = root->parent; }
+        const key_type key = root->data.first;
+        tree.erase(key);
+        reference.erase(key);
+        consistent = test::valid(tree) && test::same_pairs(tree, reference);
+    }
+    CHECK(consistent);
+    CHECK(reference.empty());
+}
+
+template <class Balance>
+void against_map(workload::distribution d)
+{
+    tree_type<Balance> tree;
+    std::map<key_type, std::size_t> reference;
+    CHECK(test::replay(tree, reference, test::trace(d, 3000, 20000)));
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(test::valid(tree));
+}
+
+template <class Balance>
+void all(const char * name)
+{
+    std::cout << name << std::endl;
+    empty_tree<Balance>();
+    single_node<Balance>();
+    duplicate_keys<Balance>();
+    erase_root<Balance>();
+    for (auto d : {workload::distribution::uniform, workload::distribution::zipf, workload::distribution::sorted,
+                   workload::distribution::reverse_sorted, workload::distribution::clustered}) {
+        against_map<Balance>(d);
+    }
+}
+
+/*! ascending keys: an AVL tree stays below 1.44 log2(N + 2) levels */
+template <class Balance>
+void avl_height()
+{
+    tree_type<Balance> tree;
+    const std::size_t count = (std::size_t{1} << 14) - 1;
+    for (std::size_t key = 0; key < count; ++key) { tree.insert(key, key); }
+    CHECK(test::valid(tree));
+    CHECK(static_cast<double>(tree.height()) < 1.4405 * std::log2(static_cast<double>(count) + 2));
+    for (std::size_t key = 0; key < count; key += 2) { tree.erase(key); }
+    CHECK(test::valid(tree));
+    CHECK(tree.size() == count / 2);
+}
+
+int main()
+{
+    all<balancing::none>("none");
+    all<balancing::avl>("avl");
+    all<balancing::ranked>("ranked");
+    all<balancing::ranked_avl>("ranked_avl");
+    avl_height<balancing::avl>();
+    avl_height<balancing::ranked_avl>();
+    return test::result();
+}
@@ -0,0 +1,104 @@
+/*
+batch lookup test
+find_batch against find and std::map on trees of every balancing policy after workload traces: keys present
+and missing, repeated in the batch, batches shorter than, equal to and longer than a group, groups of one;
+the empty tree, a single node and an empty batch
+*/
+
+#include "binary_tree.h"
+#include "test.h"
+
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <map>
+#include <vector>
+
+using key_type = std::uint64_t;
+
+template <class Balance>
+using tree_type = Tree<key_type, std::size_t, std::less<key_type>, Balance>;
+
+/*! true if find_batch with groups of Group gives the iterators of find for keys, in order */
+template <std::size_t Group, class TreeType, class Keys>
+bool batch_matches(const TreeType & tree, const Keys & keys)
+{
+    std::vector<typename TreeType::iterator> found;
+    tree.template find_batch<Group>(keys.begin(), keys.end(), std::back_inserter(found));
+    if (found.size() != keys.size()) { return false; }
+    auto it = found.begin();
+    for (const auto & key : keys) {
+        if (*it++ != tree.find(key)) { return false; }
+    }
+    return true;
+}
+
+template <class TreeType, class Keys>
+bool all_groups(const TreeType & tree, const Keys & keys)
+{
+    return batch_matches<1>(tree, keys) && batch_matches<3>(tree, keys) && batch_matches<16>(tree, keys)
+        && batch_matches<64>(tree, keys);
+}
+
+template <class Balance>
+void against_map(workload::distribution d)
+{
+    tree_type<Balance> tree;
+    std::map<key_type, std::size_t> reference;
+    CHECK(test::replay(tree, reference, test::trace(d, 4000, 20000)));
+
+    workload::key_generator keys(workload::distribution::uniform, 5000, 17);
+    std::vector<key_type> batch;
+    for (std::size_t i = 0; i < 1000; ++i) { batch.push_back(keys()); }
+    batch.push_back(batch.front());                 // repeated keys
+    CHECK(all_groups(tree, batch));
+
+    bool same = true;
+    std::vector<typename tree_type<Balance>::iterator> found(batch.size());
+    tree.find_batch(batch.begin(), batch.end(), found.begin());
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        const auto expected = reference.find(batch[i]);
+        same = same && (found[i] == tree.end()) == (expected == reference.end())
+                    && (expected == reference.end() || found[i]->second == expected->second);
+    }
+    CHECK(same);
+
+    for (std::size_t length : {0, 1, 15, 16, 17, 33}) {
+        CHECK(all_groups(tree, std::vector<key_type>(batch.begin(), batch.begin() + static_cast<std::ptrdiff_t>(length))));
+    }
+    CHECK(all_groups(tree, std::list<key_type>(batch.begin(), batch.begin() + 40)));     // forward iterators
+}
+
+template <class Balance>
+void small_trees()
+{
+    tree_type<Balance> tree;
+    const std::vector<key_type> keys{0, 1, 2, 3};
+    CHECK(all_groups(tree, keys));
+    std::vector<typename tree_type<Balance>::iterator> found(keys.size());
+    const auto end = tree.find_batch(keys.begin(), keys.end(), found.begin());
+    CHECK(end == found.end());
+    CHECK(found[0] == tree.end() && found[3] == tree.end());
+    tree.insert(2, 4);
+    CHECK(all_groups(tree, keys));
+    tree.find_batch(keys.begin(), keys.end(), found.begin());
+    CHECK(found[2]->second == 4 && found[1] == tree.end());
+}
+
+template <class Balance>
+void all()
+{
+    small_trees<Balance>();
+    for (auto d : {workload::distribution::uniform, workload::distribution::sorted, workload::distribution::zipf}) {
+        against_map<Balance>(d);
+    }
+}
+
+int main()
+{
+    all<balancing::none>();
+    all<balancing::avl>();
+    all<balancing::ranked>();
+    all<balancing::ranked_avl>();
+    return test::result();
+}
@@ -0,0 +1,116 @@
+/*
+B+ tree test
+BTree against std::map on workload traces large enough to split and merge leaves and internal nodes, with
+integer and string values, whose leaves hold fewer keys; erasing every key, in order and shuffled, down to the
+empty tree; copies, moves and the empty tree, a single pair and duplicate keys
+*/
+
+#include "btree.h"
+#include "test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <string>
+
+using key_type = std::uint64_t;
+
+template <class Value>
+void against_map(workload::distribution d)
+{
+    BTree<key_type, Value> tree;
+    std::map<key_type, Value> reference;
+    CHECK(test::replay(tree, reference, test::trace(d, 20000, 100000)));
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(static_cast<double>(tree.height()) <= 1 + std::log2(static_cast<double>(tree.size()) + 1));
+}
+
+void small_trees()
+{
+    BTree<key_type, std::string> tree;
+    CHECK(tree.empty());
+    CHECK(tree.height() == 0);
+    CHECK(tree.begin() == tree.end());
+    CHECK(tree.find(1) == tree.end());
+    tree.erase(1);
+    tree.insert(1, "one");
+    CHECK(tree.size() == 1);
+    CHECK(tree.height() == 1);
+    CHECK(tree.find(1)->second == "one");
+    tree.insert(1, "uno");                          // duplicate key: the value is overwritten
+    CHECK(tree.size() == 1);
+    CHECK(tree.find(1)->second == "uno");
+    tree.erase(tree.find(1));
+    CHECK(tree.empty());
+    CHECK(tree.begin() == tree.end());
+}
+
+/*! erases every key of a tree of several levels, checking the pairs left along the way */
+void erase_all(bool shuffled)
+{
+    BTree<key_type, key_type> tree;
+    std::map<key_type, key_type> reference;
+    std::vector<key_type> keys;
+    for (key_type key = 0; key < 20000; ++key) {
+        tree.insert(key * 3, key);
+        reference[key * 3] = key;
+        keys.push_back(key * 3);
+    }
+    CHECK(tree.height() > 2);
+    if (shuffled) {
+        workload::rng generator(11);
+        for (std::size_t i = keys.size(); i > 1; --i) { std::swap(keys[i - 1], keys[generator.below(i)]); }
+    }
+    bool consistent = true;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        tree.erase(keys[i]);
+        reference.erase(keys[i]);
+        if (i % 1000 == 0) { consistent = consistent && test::same_pairs(tree, reference); }
+    }
+    CHECK(consistent);
+    CHECK(tree.empty());
+    CHECK(tree.height() == 0);
+    tree.insert(5, 5);                              // usable after emptied
+    CHECK(tree.find(5)->second == 5);
+}
+
+void copies()
+{
+    BTree<key_type, std::string> tree;
+    std::map<key_type, std::string> reference;
+    for (key_type key = 0; key < 5000; ++key) {
+        tree.insert(key, std::to_string(key));
+        reference[key] = std::to_string(key);
+    }
+    BTree<key_type, std::string> copy(tree);
+    tree.clear();
+    CHECK(test::same_pairs(copy, reference));
+    for (key_type key = 5000; key < 6000; ++key) {  // the copied leaves are linked in order
+        copy.insert(key, std::to_string(key));
+        reference[key] = std::to_string(key);
+    }
+    CHECK(test::same_pairs(copy, reference));
+
+    BTree<key_type, std::string> moved(std::move(copy));
+    CHECK(test::same_pairs(moved, reference));
+    tree = moved;
+    moved.erase(0);
+    CHECK(test::same_pairs(tree, reference));
+    tree = BTree<key_type, std::string>();
+    CHECK(tree.empty());
+}
+
+int main()
+{
+    small_trees();
+    for (auto d : {workload::distribution::uniform, workload::distribution::zipf, workload::distribution::sorted,
+                   workload::distribution::reverse_sorted, workload::distribution::clustered}) {
+        against_map<std::size_t>(d);
+    }
+    against_map<std::string>(workload::distribution::uniform);
+    erase_all(false);
+    erase_all(true);
+    copies();
+    return test::result();
+}
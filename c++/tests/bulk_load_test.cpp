@@ -0,0 +1,133 @@
+/*
+bulk load test
+insert(first, last) and the range and list constructors against std::map filled one pair at a time: sorted
+and unsorted input, duplicate keys (the last value wins), ranges into a tree that is not empty, move-only
+values moved out of the range, and pool allocated nodes; loading into an empty tree must give a tree of
+minimum height. Covers the empty range and a single pair
+*/
+
+#include "binary_tree.h"
+#include "pool_allocator.h"
+#include "test.h"
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using key_type = std::uint64_t;
+using pair_type = std::pair<key_type, std::string>;
+
+/*! levels of a tree of minimum height holding count nodes */
+std::size_t minimum_height(std::size_t count)
+{
+    std::size_t levels = 0;
+    while (count >> levels) { ++levels; }
+    return levels;
+}
+
+/*! std::map with the pairs of [first, last) inserted in turn, later values overwriting earlier ones */
+template <class InputIt>
+std::map<key_type, std::string> inserted(InputIt first, InputIt last)
+{
+    std::map<key_type, std::string> reference;
+    for (; first != last; ++first) { reference[first->first] = first->second; }
+    return reference;
+}
+
+/*! count pairs with keys drawn from d in [0, key_space) */
+std::vector<pair_type> pairs(workload::distribution d, std::uint64_t key_space, std::size_t count)
+{
+    workload::key_generator keys(d, key_space, 5);
+    std::vector<pair_type> result;
+    for (std::size_t i = 0; i < count; ++i) { result.emplace_back(keys(), std::to_string(i)); }
+    return result;
+}
+
+template <class TreeType, class Range>
+void check_load(const Range & range)
+{
+    TreeType tree;
+    tree.insert(range.begin(), range.end());
+    const auto reference = inserted(range.begin(), range.end());
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(test::valid(tree));
+    CHECK(tree.height() == minimum_height(tree.size()));
+}
+
+template <class TreeType>
+void loads()
+{
+    check_load<TreeType>(std::vector<pair_type>());
+    check_load<TreeType>(std::vector<pair_type>{{4, "four"}});
+    for (auto d : {workload::distribution::sorted, workload::distribution::uniform,
+                   workload::distribution::reverse_sorted, workload::distribution::zipf}) {
+        check_load<TreeType>(pairs(d, 100000, 10000));
+        check_load<TreeType>(pairs(d, 1000, 10000));     // many duplicates
+    }
+    const auto sorted = pairs(workload::distribution::sorted, 100000, 5000);
+    check_load<TreeType>(std::list<pair_type>(sorted.begin(), sorted.end()));
+    check_load<TreeType>(std::vector<pair_type>{{1, "a"}, {1, "b"}, {2, "c"}, {2, "d"}, {2, "e"}});
+}
+
+void into_filled_tree()
+{
+    Tree<key_type, std::string> tree{{10, "ten"}, {20, "twenty"}};
+    const auto range = pairs(workload::distribution::uniform, 100, 500);
+    tree.insert(range.begin(), range.end());
+    auto reference = inserted(range.begin(), range.end());
+    if (!reference.count(10)) { reference[10] = "ten"; }
+    if (!reference.count(20)) { reference[20] = "twenty"; }
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(test::valid(tree));
+}
+
+void constructors()
+{
+    Tree<key_type, std::string> list{{3, "c"}, {1, "a"}, {2, "b"}, {1, "z"}};
+    CHECK(test::same_pairs(list, std::map<key_type, std::string>{{1, "z"}, {2, "b"}, {3, "c"}}));
+    CHECK(test::valid(list));
+
+    const auto range = pairs(workload::distribution::uniform, 10000, 3000);
+    Tree<key_type, std::string, std::greater<key_type>> reversed(range.begin(), range.end(), std::greater<key_type>());
+    std::map<key_type, std::string, std::greater<key_type>> reference;
+    for (const auto & pair : range) { reference[pair.first] = pair.second; }
+    CHECK(test::same_pairs(reversed, reference));
+    CHECK(test::valid(reversed));
+    CHECK(reversed.height() == minimum_height(reversed.size()));
+}
+
+/*! values that can only be moved are moved out of a range wrapped in move iterators */
+void move_only_values()
+{
+    for (bool sorted : {true, false}) {
+        std::vector<std::pair<key_type, std::unique_ptr<key_type>>> range;
+        for (key_type i = 0; i < 1000; ++i) {
+            const key_type key = sorted ? i : (i * 7919) % 1000;
+            range.emplace_back(key, std::make_unique<key_type>(key));
+        }
+        Tree<key_type, std::unique_ptr<key_type>> tree;
+        tree.insert(std::make_move_iterator(range.begin()), std::make_move_iterator(range.end()));
+        CHECK(tree.size() == 1000);
+        CHECK(test::valid(tree));
+        std::size_t right = 0, moved = 0;
+        for (auto it = tree.begin(); it != tree.end(); ++it) { right += it->second && *it->second == it->first; }
+        for (const auto & pair : range) { moved += !pair.second; }
+        CHECK(right == 1000);
+        CHECK(moved == 1000);
+    }
+}
+
+int main()
+{
+    loads<Tree<key_type, std::string>>();
+    loads<Tree<key_type, std::string, std::less<key_type>, balancing::avl>>();
+    loads<Tree<key_type, std::string, std::less<key_type>, balancing::ranked>>();
+    loads<Tree<key_type, std::string, std::less<key_type>, balancing::none, pool_allocator<std::pair<const key_type, std::string>>>>();
+    into_filled_tree();
+    constructors();
+    move_only_values();
+    return test::result();
+}
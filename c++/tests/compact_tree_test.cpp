@@ -0,0 +1,139 @@
+/*
+compact tree test
+CompactTree, with and without parent links, against std::map on workload traces: erase moves the entry stored
+last into the freed slot, which must keep every link right; balance() to minimum height, backward iteration,
+clear() and reuse, string values and a transparent comparator; the empty tree, a single entry and duplicate keys
+*/
+
+#include "compact_tree.h"
+#include "test.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+
+using key_type = std::uint64_t;
+
+/*! levels of a tree of minimum height holding count nodes */
+std::size_t minimum_height(std::size_t count)
+{
+    std::size_t levels = 0;
+    while (count >> levels) { ++levels; }
+    return levels;
+}
+
+/*! true if iterating tree backwards, from end(), gives the pairs of reference in reverse order */
+template <class TreeType, class Reference>
+bool same_backwards(const TreeType & tree, const Reference & reference)
+{
+    auto it = tree.end();
+    for (auto pair = reference.rbegin(); pair != reference.rend(); ++pair) {
+        if (it == tree.begin()) { return false; }
+        --it;
+        if (!(it->first == pair->first) || !(it->second == pair->second)) { return false; }
+    }
+    return it == tree.begin();
+}
+
+template <bool ParentLinks, class Value>
+void against_map(workload::distribution d)
+{
+    CompactTree<key_type, Value, std::less<key_type>, ParentLinks> tree;
+    std::map<key_type, Value> reference;
+    CHECK(test::replay(tree, reference, test::trace(d, 3000, 20000)));
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(same_backwards(tree, reference));
+
+    tree.balance();
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(tree.height() == minimum_height(tree.size()));
+    CHECK(test::replay(tree, reference, test::trace(d, 3000, 5000, {4, 4, 2}, 7)));   // keeps working
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(same_backwards(tree, reference));
+}
+
+template <bool ParentLinks>
+void small_trees()
+{
+    CompactTree<key_type, std::string, std::less<key_type>, ParentLinks> tree;
+    CHECK(tree.empty());
+    CHECK(tree.height() == 0);
+    CHECK(tree.begin() == tree.end());
+    CHECK(tree.find(1) == tree.end());
+    tree.erase(1);
+    tree.balance();
+    CHECK(tree.empty());
+
+    tree.insert(1, "one");
+    tree.insert(1, "uno");                          // duplicate key: overwritten
+    CHECK(tree.size() == 1);
+    CHECK(tree.find(1)->second == "uno");
+    CHECK(std::prev(tree.end()) == tree.begin());
+    tree.erase(tree.begin());
+    CHECK(tree.empty());
+    CHECK(tree.begin() == tree.end());
+
+    for (key_type key = 0; key < 100; ++key) { tree.insert(key, std::to_string(key)); }
+    const std::size_t memory = tree.memory();
+    tree.clear();
+    CHECK(tree.empty());
+    CHECK(tree.memory() == memory);                 // the capacity is kept for reuse
+    tree.insert(5, "five");
+    CHECK(tree.find(5)->second == "five" && tree.size() == 1);
+}
+
+/*! erases the root, and the entries stored first and last in the arrays, checking the tree after each */
+template <bool ParentLinks>
+void erase_everywhere()
+{
+    CompactTree<key_type, key_type, std::less<key_type>, ParentLinks> tree;
+    std::map<key_type, key_type> reference;
+    workload::rng generator(5);
+    for (int i = 0; i < 500; ++i) {
+        const key_type key = generator.below(2000);
+        tree.insert(key, key);
+        reference[key] = key;
+    }
+    bool consistent = true;
+    for (int i = 0; !reference.empty() && consistent; ++i) {
+        const key_type key = i % 3 == 0 ? reference.begin()->first : i % 3 == 1 ? reference.rbegin()->first
+                                        : std::next(reference.begin(), static_cast<std::ptrdiff_t>(reference.size() / 2))->first;
+        tree.erase(key);
+        reference.erase(key);
+        consistent = test::same_pairs(tree, reference) && same_backwards(tree, reference);
+    }
+    CHECK(consistent);
+    CHECK(tree.empty());
+}
+
+void transparent_lookup()
+{
+    CompactTree<std::string, int, std::less<>> tree;
+    for (int i = 0; i < 100; ++i) { tree.insert("key " + std::to_string(i), i); }
+    CHECK(tree.find(std::string_view("key 42"))->second == 42);
+    CHECK(tree.find("key 100") == tree.end());
+    tree.erase(std::string_view("key 42"));
+    CHECK(tree.find("key 42") == tree.end());
+    CHECK(tree.size() == 99);
+}
+
+template <bool ParentLinks>
+void all()
+{
+    small_trees<ParentLinks>();
+    for (auto d : {workload::distribution::uniform, workload::distribution::zipf, workload::distribution::sorted,
+                   workload::distribution::clustered}) {
+        against_map<ParentLinks, std::size_t>(d);
+    }
+    against_map<ParentLinks, std::string>(workload::distribution::uniform);
+    erase_everywhere<ParentLinks>();
+}
+
+int main()
+{
+    all<true>();
+    all<false>();
+    transparent_lookup();
+    return test::result();
+}
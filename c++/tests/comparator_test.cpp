@@ -0,0 +1,124 @@
+/*
+comparator test
+trees ordered by std::greater and by a case insensitive comparator against std::map with the same comparator;
+heterogeneous find, erase, count and bounds with the transparent std::less<> on string keys, taking
+std::string_view and const char * without building a std::string; and a single comparison per level
+*/
+
+#include "binary_tree.h"
+#include "test.h"
+
+#include <cctype>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+
+using key_type = std::uint64_t;
+
+void greater_order()
+{
+    Tree<key_type, std::size_t, std::greater<key_type>, balancing::avl> tree;
+    std::map<key_type, std::size_t, std::greater<key_type>> reference;
+    CHECK(test::replay(tree, reference, test::trace(workload::distribution::uniform, 3000, 20000)));
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(test::valid(tree));
+    CHECK(tree.lower_bound(1500) == tree.find(reference.lower_bound(1500)->first));
+}
+
+/*! orders strings ignoring the case of letters */
+struct case_insensitive {
+    bool operator()(const std::string & lhs, const std::string & rhs) const {
+        for (std::size_t i = 0; i < lhs.size() && i < rhs.size(); ++i) {
+            const int l = std::tolower(static_cast<unsigned char>(lhs[i])), r = std::tolower(static_cast<unsigned char>(rhs[i]));
+            if (l != r) { return l < r; }
+        }
+        return lhs.size() < rhs.size();
+    }
+};
+
+void custom_comparator()
+{
+    Tree<std::string, int, case_insensitive> tree;
+    std::map<std::string, int, case_insensitive> reference;
+    for (const char * key : {"Beta", "alpha", "ALPHA", "gamma", "Gamma", "delta", ""}) {
+        tree.insert(key, static_cast<int>(reference.size()));
+        reference[key] = static_cast<int>(reference.size());
+    }
+    CHECK(tree.size() == 5);
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(tree.find("BETA") != tree.end());
+    tree.erase("GAMMA");
+    reference.erase("GAMMA");
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(test::valid(tree));
+}
+
+void transparent_lookup()
+{
+    Tree<std::string, int, std::less<>> tree;
+    std::map<std::string, int, std::less<>> reference;
+    for (int i = 0; i < 1000; ++i) {
+        const std::string key = "key" + std::to_string(i);
+        tree.insert(key, i);
+        reference[key] = i;
+    }
+    std::size_t found = 0;
+    for (int i = 0; i < 1000; ++i) {
+        const std::string text = "key" + std::to_string(i) + " suffix";
+        const std::string_view key(text.data(), text.size() - 7);
+        auto it = tree.find(key);
+        found += it != tree.end() && it->second == i;
+    }
+    CHECK(found == 1000);
+    CHECK(tree.find("key999") != tree.end());
+    CHECK(tree.find("key1000") == tree.end());
+    CHECK(tree.find(std::string_view()) == tree.end());
+    CHECK(tree.count(std::string_view("key5")) == 1);
+    CHECK(tree.lower_bound("key5") == tree.find("key5"));
+    CHECK(tree.upper_bound(std::string_view("key5"))->first == reference.upper_bound("key5")->first);
+    CHECK(tree.rank("key5") == static_cast<std::size_t>(std::distance(reference.begin(), reference.find("key5"))));
+
+    tree.erase(std::string_view("key5"));
+    tree.erase("key6");
+    tree.erase("not a key");
+    reference.erase("key5");
+    reference.erase("key6");
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(test::valid(tree));
+}
+
+/*! comparator counting its calls */
+struct counting_less {
+    static std::size_t & calls() {
+        static std::size_t count = 0;
+        return count;
+    }
+    bool operator()(key_type lhs, key_type rhs) const {
+        ++calls();
+        return lhs < rhs;
+    }
+};
+
+/*! find compares the key once per level, plus once at the end for the key found */
+void comparisons_per_level()
+{
+    Tree<key_type, key_type, counting_less, balancing::avl> tree;
+    for (key_type key = 0; key < 4000; key += 2) { tree.insert(key, key); }
+    bool within = true;
+    for (key_type key = 0; key < 4001; ++key) {
+        counting_less::calls() = 0;
+        tree.find(key);
+        within = within && counting_less::calls() <= tree.height() + 1;
+    }
+    CHECK(within);
+}
+
+int main()
+{
+    greater_order();
+    custom_comparator();
+    transparent_lookup();
+    comparisons_per_level();
+    return test::result();
+}
@@ -0,0 +1,153 @@
+/*
+concurrent tree test
+ConcurrentTree against std::map on a workload trace; readers running alongside a writer must always see a
+complete version of the tree, which does not change while they hold it; batched updates, updates that throw,
+and a tree starting from a copy, empty or holding a single pair
+*/
+
+#include "binary_tree.h"
+#include "concurrent_tree.h"
+#include "test.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using key_type = std::uint64_t;
+using concurrent_type = ConcurrentTree<key_type, std::size_t, std::less<key_type>, balancing::avl>;
+
+void against_map()
+{
+    concurrent_type tree(2);
+    std::map<key_type, std::size_t> reference;
+    bool same = true;
+    const auto trace = test::trace(workload::distribution::zipf, 2000, 10000);
+    for (std::size_t i = 0; i < trace.size(); ++i) {
+        const key_type key = trace[i].key;
+        switch (trace[i].kind) {
+            case workload::op::find:
+                same = same && tree.read([&](const concurrent_type::tree_type & t) { return t.count(key); }) == reference.count(key);
+                break;
+            case workload::op::insert:
+                tree.insert(key, i);
+                reference[key] = i;
+                break;
+            case workload::op::erase:
+                tree.erase(key);
+                reference.erase(key);
+                break;
+        }
+    }
+    CHECK(same);
+    auto pinned = tree.read();
+    CHECK(test::same_pairs(*pinned, reference));
+    CHECK(test::valid(*pinned));
+}
+
+/*! the writer inserts the keys 0, 1, 2... in order, in batches of three: a complete version of size n holds
+    exactly the keys below n, and n is a multiple of three */
+void readers_and_writer()
+{
+    const key_type count = 3000;
+    concurrent_type tree(4);
+    std::atomic<bool> done{false};
+    std::atomic<std::size_t> broken{0}, reads{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            std::size_t last = 0;
+            do {                                    // at least once, even if the writer is already done
+                auto pinned = tree.read();
+                const std::size_t n = pinned->size();
+                bool complete = n % 3 == 0 && n >= last;
+                if (n > 0) {
+                    auto highest = pinned->rbegin();
+                    complete = complete && pinned->begin() == pinned->find(0) && highest->first == n - 1
+                                        && pinned->find(n / 2)->second == n / 2;
+                }
+                complete = complete && pinned->size() == n && pinned->find(n) == pinned->end();
+                broken += !complete;
+                last = n;
+                ++reads;
+                std::this_thread::yield();          // lets the writer run on machines with few cores
+            } while (!done.load());
+        });
+    }
+    for (key_type key = 0; key < count; key += 3) {
+        tree.update([key](concurrent_type::tree_type & t) {
+            for (key_type k = key; k < key + 3; ++k) { t.insert(k, k); }
+        });
+    }
+    done = true;
+    for (auto & reader : readers) { reader.join(); }
+    CHECK(broken == 0);
+    CHECK(reads > 0);
+    CHECK(tree.size() == count);
+    CHECK(test::valid(*tree.read()));
+}
+
+/*! a change throwing leaves the two copies equal: either without the change, or with all of it */
+void throwing_update()
+{
+    concurrent_type tree;
+    tree.insert(1, 1);
+    int calls = 0;
+    try {
+        tree.update([&calls](concurrent_type::tree_type & t) {
+            t.insert(2, 2);
+            if (++calls == 1) { throw std::runtime_error("first copy"); }
+        });
+    } catch (const std::runtime_error &) {}
+    CHECK(tree.read()->size() == 1);
+    tree.insert(3, 3);                              // both copies still agree
+    CHECK(test::same_pairs(*tree.read(), std::map<key_type, std::size_t>{{1, 1}, {3, 3}}));
+
+    calls = 0;
+    try {
+        tree.update([&calls](concurrent_type::tree_type & t) {
+            t.insert(4, 4);
+            if (++calls == 2) { throw std::runtime_error("second copy"); }
+        });
+    } catch (const std::runtime_error &) {}
+    tree.erase(1);
+    CHECK(test::same_pairs(*tree.read(), std::map<key_type, std::size_t>{{3, 3}, {4, 4}}));
+    tree.insert(5, 5);                              // readers now see the other copy
+    CHECK(test::same_pairs(*tree.read(), std::map<key_type, std::size_t>{{3, 3}, {4, 4}, {5, 5}}));
+}
+
+void small_trees()
+{
+    concurrent_type empty(0);                       // a slot at least
+    CHECK(empty.size() == 0);
+    CHECK(empty.read()->begin() == empty.read()->end());
+    empty.erase(1);
+    CHECK(empty.size() == 0);
+
+    concurrent_type::tree_type single;
+    single.insert(9, 81);
+    concurrent_type copy(single, 1);
+    single.clear();
+    CHECK(copy.size() == 1);
+    CHECK(copy.read([](const concurrent_type::tree_type & t) { return t.find(9)->second; }) == 81);
+    copy.erase(9);
+    CHECK(copy.size() == 0);
+    copy.insert(9, 9);
+    copy.insert(9, 10);                             // duplicate key: overwritten in both copies
+    CHECK(copy.size() == 1);
+    for (int i = 0; i < 2; ++i) {                   // every update flips the copy readers see
+        CHECK(copy.read([](const concurrent_type::tree_type & t) { return t.find(9)->second; }) == 10);
+        copy.insert(8, 8);
+    }
+}
+
+int main()
+{
+    against_map();
+    readers_and_writer();
+    throwing_update();
+    small_trees();
+    return test::result();
+}
@@ -0,0 +1,101 @@
+/*
+copy and clear test
+deep copies, copy assignment, clear() and destruction of a tree with a million levels, built from ascending keys
+by a tree that never rebalances, which would overflow the stack if any of them recursed on the depth; a shorter
+chain of descending keys, whose inserts walk the whole chain; and copies of balanced trees against std::map,
+covering the empty tree, a single node and self assignment
+*/
+
+#include "binary_tree.h"
+#include "test.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+using key_type = std::uint64_t;
+using chain_type = Tree<key_type, std::string, std::less<key_type>, balancing::none>;
+
+/*! true if the two trees hold the same pairs, walking them in order without recursion */
+template <class TreeType>
+bool same_tree(const TreeType & tree, const TreeType & other)
+{
+    if (tree.size() != other.size()) { return false; }
+    auto it = other.begin();
+    for (auto pair = tree.begin(); pair != tree.end(); ++pair, ++it) {
+        if (!(pair->first == it->first) || !(pair->second == it->second)) { return false; }
+    }
+    return true;
+}
+
+/*! a list of count nodes: ascending keys hang on the right, descending ones on the left */
+chain_type chain(std::size_t count, bool ascending)
+{
+    chain_type tree;
+    for (key_type i = 0; i < count; ++i) {
+        const key_type key = ascending ? i : count - i;
+        tree.insert(ascending ? tree.end() : tree.begin(), key, std::to_string(key));
+    }
+    return tree;
+}
+
+void deep_chain(std::size_t count, bool ascending)
+{
+    chain_type tree = chain(count, ascending);
+    CHECK(tree.height() == count);
+
+    chain_type copy(tree);
+    CHECK(copy.height() == count);
+    CHECK(same_tree(copy, tree));
+
+    chain_type assigned = chain(10, !ascending);
+    assigned = copy;
+    CHECK(same_tree(assigned, tree));
+
+    copy.clear();
+    CHECK(copy.empty());
+    CHECK(copy.begin() == copy.end());
+    copy.insert(1, "one");                      // a cleared tree is usable
+    CHECK(copy.size() == 1);
+}                                                // destroys the two deep chains, tree and assigned
+
+void balanced_copies()
+{
+    using tree_type = Tree<key_type, std::size_t, std::less<key_type>, balancing::avl>;
+    tree_type empty;
+    tree_type copy_of_empty(empty);
+    CHECK(copy_of_empty.empty());
+    CHECK(test::valid(copy_of_empty));
+
+    tree_type single;
+    single.insert(3, 9);
+    tree_type copy_of_single(single);
+    CHECK(copy_of_single.find(3)->second == 9);
+    CHECK(test::valid(copy_of_single));
+
+    tree_type tree;
+    std::map<key_type, std::size_t> reference;
+    CHECK(test::replay(tree, reference, test::trace(workload::distribution::uniform, 5000, 20000)));
+    tree_type copy(tree);
+    CHECK(test::valid(copy));
+    CHECK(test::same_pairs(copy, reference));
+    tree.clear();
+    CHECK(test::same_pairs(copy, reference));        // the copy owns its nodes
+
+    const tree_type & same = copy;
+    copy = same;                                     // self assignment keeps the pairs
+    CHECK(test::same_pairs(copy, reference));
+    copy = empty;
+    CHECK(copy.empty());
+    CHECK(test::valid(copy));
+    copy = single;
+    CHECK(test::same_pairs(copy, std::map<key_type, std::size_t>{{3, 9}}));
+}
+
+int main()
+{
+    deep_chain(1000000, true);
+    deep_chain(5000, false);
+    balanced_copies();
+    return test::result();
+}
@@ -0,0 +1,127 @@
+/*
+frozen tree test
+FrozenTree built with freeze() from trees of every size up to a few complete levels, and from workload
+traces, against std::map: iteration in order, find of every key present and of the keys between, below and
+above them; string keys, a reversed comparator, and the Eytzinger helpers against a plain loop
+*/
+
+#include "binary_tree.h"
+#include "frozen_tree.h"
+#include "test.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+using key_type = std::uint64_t;
+
+/*! true if frozen finds every key of reference with its value, and none of the keys in missing */
+template <class Frozen, class Reference, class Missing>
+bool finds(const Frozen & frozen, const Reference & reference, const Missing & missing)
+{
+    for (const auto & pair : reference) {
+        const auto it = frozen.find(pair.first);
+        if (it == frozen.end() || !(it->first == pair.first) || !(it->second == pair.second)) { return false; }
+    }
+    for (const auto & key : missing) {
+        if (frozen.find(key) != frozen.end()) { return false; }
+    }
+    return true;
+}
+
+/*! odd keys 1, 3, ..., 2 count - 1: the even ones are missing, below, between and above them */
+void every_size()
+{
+    bool all_found = true, all_ordered = true;
+    for (std::size_t count = 0; count <= 300; ++count) {
+        Tree<key_type, std::size_t> tree;
+        std::map<key_type, std::size_t> reference;
+        std::vector<key_type> missing;
+        for (key_type i = 0; i < count; ++i) {
+            tree.insert(2 * i + 1, i);
+            reference[2 * i + 1] = i;
+            missing.push_back(2 * i);
+        }
+        missing.push_back(2 * count);
+        const auto frozen = tree.freeze();
+        all_ordered = all_ordered && frozen.size() == count && test::same_pairs(frozen, reference);
+        all_found = all_found && finds(frozen, reference, missing);
+    }
+    CHECK(all_ordered);
+    CHECK(all_found);
+
+    FrozenTree<key_type, std::size_t> empty;
+    CHECK(empty.empty());
+    CHECK(empty.begin() == empty.end());
+    CHECK(empty.find(0) == empty.end());
+}
+
+void against_map(workload::distribution d)
+{
+    Tree<key_type, std::size_t> tree;
+    std::map<key_type, std::size_t> reference;
+    CHECK(test::replay(tree, reference, test::trace(d, 100000, 50000)));
+    const auto frozen = tree.freeze();
+    CHECK(test::same_pairs(frozen, reference));
+    std::vector<key_type> missing;
+    for (key_type key = 0; key < 100000; key += 7) {
+        if (reference.count(key) == 0) { missing.push_back(key); }
+    }
+    CHECK(finds(frozen, reference, missing));
+}
+
+void string_keys()
+{
+    Tree<std::string, int> tree;
+    std::map<std::string, int> reference;
+    for (int i = 0; i < 500; ++i) {
+        const std::string key = "key " + std::to_string(i * 3);
+        tree.insert(key, i);
+        reference[key] = i;
+    }
+    tree.insert("", -1);
+    reference[""] = -1;
+    const auto frozen = tree.freeze();
+    CHECK(test::same_pairs(frozen, reference));
+    CHECK(finds(frozen, reference, std::vector<std::string>{"key 1", "key", "key 99999", "zzz", " "}));
+}
+
+void reversed_order()
+{
+    Tree<key_type, key_type, std::greater<key_type>> tree;
+    std::map<key_type, key_type, std::greater<key_type>> reference;
+    for (key_type key = 0; key < 1000; key += 2) {
+        tree.insert(key, key * key);
+        reference[key] = key * key;
+    }
+    const auto frozen = tree.freeze();
+    CHECK(test::same_pairs(frozen, reference));
+    CHECK(finds(frozen, reference, std::vector<key_type>{1, 501, 999, 1000}));
+}
+
+/*! eytzingerUndoRightTurns, a builtin where available, against the loop it replaces */
+void undo_right_turns()
+{
+    bool same = true;
+    for (std::size_t k = 1; k < 100000; ++k) {
+        std::size_t expected = k;
+        while (expected & 1) { expected >>= 1; }
+        same = same && detail::eytzingerUndoRightTurns(k) == expected >> 1;
+    }
+    const std::size_t ones = ~std::size_t{0} >> 1;
+    same = same && detail::eytzingerUndoRightTurns(ones) == 0 && detail::eytzingerUndoRightTurns(ones - 1) == (ones - 1) >> 1;
+    CHECK(same);
+    static_assert(detail::eytzingerUndoRightTurns(0b10111) == 0b1, "usable in constant expressions");
+}
+
+int main()
+{
+    every_size();
+    for (auto d : {workload::distribution::uniform, workload::distribution::zipf, workload::distribution::clustered}) {
+        against_map(d);
+    }
+    string_keys();
+    reversed_order();
+    undo_right_turns();
+    return test::result();
+}
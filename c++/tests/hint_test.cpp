@@ -0,0 +1,121 @@
+/*
+hint test
+insert with a hint, emplace_hint, find with a hint, insert_near and find_near against std::map and plain insert
+and find: good hints (end() when appending, the previous result), hints far from the key, and end() on the
+empty tree; with every balancing policy, and with counters checking that appends and nearby keys visit few nodes
+*/
+
+#include "binary_tree.h"
+#include "test.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+using key_type = std::uint64_t;
+
+template <class Balance, class Instrument = instrument::none>
+using tree_type = Tree<key_type, std::size_t, std::less<key_type>, Balance, std::allocator<std::pair<const key_type, std::size_t>>, Instrument>;
+
+/*! replays trace with hinted inserts and finds: hints are the previous result, end(), begin() or a random node */
+template <class Balance>
+void against_map(workload::distribution d)
+{
+    tree_type<Balance> tree;
+    std::map<key_type, std::size_t> reference;
+    workload::rng generator(3);
+    auto previous = tree.end();
+    bool same = true;
+    const auto trace = test::trace(d, 5000, 30000);
+    for (std::size_t i = 0; i < trace.size() && same; ++i) {
+        const key_type key = trace[i].key;
+        const auto choice = generator.below(4);
+        const auto hint = choice == 0 ? previous : choice == 1 ? tree.end() : choice == 2 ? tree.begin()
+                                : tree.empty() ? tree.end() : tree.select(static_cast<std::size_t>(generator.below(tree.size())));
+        switch (trace[i].kind) {
+            case workload::op::find: {
+                auto it = tree.find(hint, key);
+                const auto expected = reference.find(key);
+                same = (it == tree.end()) == (expected == reference.end()) && (it == tree.end() || it->second == expected->second);
+                auto near = tree.find_near(key);
+                same = same && near == it;
+                if (it != tree.end()) { previous = it; }
+                break;
+            }
+            case workload::op::insert:
+                if (i % 2) {
+                    previous = tree.insert(hint, key, i);
+                    same = previous->first == key && previous->second == i;
+                } else {
+                    tree.insert_near(key, i);
+                    previous = tree.find(key);
+                }
+                reference[key] = i;
+                break;
+            case workload::op::erase:
+                if (previous != tree.end() && previous->first == key) { previous = tree.end(); }
+                tree.erase(key);
+                reference.erase(key);
+                break;
+        }
+    }
+    CHECK(same);
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(test::valid(tree));
+}
+
+template <class Balance>
+void emplace_hint()
+{
+    Tree<key_type, std::string, std::less<key_type>, Balance> tree;
+    auto it = tree.emplace_hint(tree.end(), 5, "five");
+    CHECK(it->first == 5 && it->second == "five");
+    it = tree.emplace_hint(it, 5, "cinque");        // present: the value is left untouched, as in std::map
+    CHECK(it->second == "five");
+    CHECK(tree.size() == 1);
+    for (key_type key = 0; key < 100; ++key) { it = tree.emplace_hint(it, key * 3 % 100, std::to_string(key)); }
+    CHECK(tree.size() == 100);
+    CHECK(tree.find(5)->second == "five");
+    CHECK(test::valid(tree));
+
+    tree.insert(tree.begin(), 5, "cinque");         // insert with a hint overwrites, as insert(key, value)
+    CHECK(tree.find(5)->second == "cinque");
+}
+
+template <class Balance>
+void few_visits()
+{
+    tree_type<Balance, instrument::counting> tree;
+    for (key_type key = 0; key < 10000; ++key) { tree.insert(tree.end(), key * 10, key); }
+    CHECK(tree.stats().insert.visited == 0);        // appends link after the highest key directly
+    CHECK(tree.size() == 10000);
+
+    tree.reset_stats();
+    for (key_type key = 50000; key < 51000; ++key) { tree.insert_near(key, key); }
+    CHECK(tree.stats().insert.visited < 1000 * 5);  // a handful of nodes each, instead of the height of the tree
+    tree.reset_stats();
+    for (key_type key = 50000; key < 51000; ++key) { tree.find_near(key); }
+    CHECK(tree.stats().find.visited < 1000 * 5);
+    CHECK(test::valid(tree));
+}
+
+template <class Balance>
+void all(const char * name)
+{
+    std::cout << name << std::endl;
+    for (auto d : {workload::distribution::uniform, workload::distribution::sorted, workload::distribution::clustered}) {
+        against_map<Balance>(d);
+    }
+    emplace_hint<Balance>();
+}
+
+int main()
+{
+    all<balancing::none>("none");
+    all<balancing::avl>("avl");
+    all<balancing::ranked>("ranked");
+    all<balancing::ranked_avl>("ranked_avl");
+    few_visits<balancing::avl>();
+    return test::result();
+}
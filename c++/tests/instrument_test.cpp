@@ -0,0 +1,132 @@
+/*
+instrumentation test
+instrument::counting against the operations replayed from a workload trace: calls of find, insert and erase,
+comparisons and nodes visited, the histogram of the depths of find, the live nodes and height, balance calls,
+reset_stats() and the JSON dump; instrument::none adds no data and reports only the shape of the tree.
+Covers the empty tree and a single node
+*/
+
+#include "binary_tree.h"
+#include "test.h"
+#include "thread_pool.h"
+
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <string>
+
+using key_type = std::uint64_t;
+using pair_type = std::pair<const key_type, std::size_t>;
+
+template <class Balance, class Instrument>
+using tree_type = Tree<key_type, std::size_t, std::less<key_type>, Balance, std::allocator<pair_type>, Instrument>;
+
+template <class Balance>
+void against_trace()
+{
+    tree_type<Balance, instrument::counting> tree;
+    std::map<key_type, std::size_t> reference;
+    const auto trace = test::trace(workload::distribution::zipf, 3000, 20000);
+    CHECK(test::replay(tree, reference, trace));
+    std::size_t finds = 0, inserts = 0, erases = 0;
+    for (const auto & request : trace) {
+        finds += request.kind == workload::op::find;
+        inserts += request.kind == workload::op::insert;
+        erases += request.kind == workload::op::erase;
+    }
+    const auto stats = tree.stats();
+    CHECK(stats.find.calls == finds);
+    CHECK(stats.insert.calls == inserts);
+    CHECK(stats.erase.calls == erases);
+
+    std::uint64_t depth_calls = 0, depth_visits = 0;
+    for (std::size_t d = 0; d < stats.depths.size(); ++d) {
+        depth_calls += stats.depths[d];
+        depth_visits += d * stats.depths[d];
+    }
+    CHECK(depth_calls == stats.find.calls);
+    CHECK(depth_visits == stats.find.visited);
+    CHECK(stats.find.comparisons >= stats.find.visited);              // one per level, one more for a match
+    CHECK(stats.find.comparisons <= stats.find.visited + stats.find.calls);
+    CHECK(stats.live_nodes == reference.size());
+    CHECK(stats.live_bytes >= reference.size() * sizeof(pair_type));
+    CHECK(stats.height == tree.height());
+    CHECK(stats.balance_calls == 0);
+}
+
+void descents()
+{
+    tree_type<balancing::avl, instrument::counting> tree;
+    CHECK(tree.stats().live_nodes == 0 && tree.stats().height == 0);
+    tree.find(1);                                   // empty tree: a descent of no node
+    CHECK(tree.stats().find.calls == 1 && tree.stats().find.visited == 0 && tree.stats().depths[0] == 1);
+
+    tree.insert(1, 1);
+    tree.reset_stats();
+    CHECK(tree.stats().find.calls == 0 && tree.stats().depths[0] == 0);
+    const auto & constant = tree;
+    constant.find(1);                               // const lookups are counted too
+    CHECK(tree.stats().find.calls == 1 && tree.stats().find.visited == 1 && tree.stats().find.comparisons == 2);
+
+    for (key_type key = 2; key <= 1023; ++key) { tree.insert(key, key); }
+    tree.reset_stats();
+    for (key_type key = 1; key <= 1023; ++key) { tree.find(key); }
+    CHECK(tree.stats().find.visited <= 1023 * tree.height());
+    CHECK(tree.stats().depths[tree.height()] > 0);
+    CHECK(tree.stats().depths[tree.height() + 1] == 0);
+
+    thread_pool pool(2);
+    tree.balance();
+    tree.balance(pool);
+    CHECK(tree.stats().balance_calls == 2);
+    tree.erase(5);
+    tree.erase(5);                                  // missing: a descent all the same
+    CHECK(tree.stats().erase.calls == 2);
+}
+
+void json()
+{
+    tree_type<balancing::avl, instrument::counting> tree;
+    for (key_type key = 0; key < 7; ++key) { tree.insert(key, key); }
+    tree.find(3);
+    tree.find(100);
+    std::ostringstream out;
+    tree.stats().write_json(out);
+    const std::string text = out.str();
+    CHECK(text.front() == '{' && text.back() == '}');
+    CHECK(text.find("\"find\":{\"calls\":2,") != std::string::npos);
+    CHECK(text.find("\"insert\":{\"calls\":7,") != std::string::npos);
+    CHECK(text.find("\"live_nodes\":7,") != std::string::npos);
+    CHECK(text.find("\"height\":3,") != std::string::npos);
+    CHECK(text.find("\"depths\":[0,0,0,2]") != std::string::npos);  // a descent always reaches a leaf
+
+    std::ostringstream readable;
+    readable << tree.stats();
+    CHECK(readable.str().find("find: 2 calls") != std::string::npos);
+}
+
+void no_instrumentation()
+{
+    static_assert(sizeof(tree_type<balancing::avl, instrument::none>) < sizeof(tree_type<balancing::avl, instrument::counting>),
+                  "instrument::none adds no data");
+    tree_type<balancing::avl, instrument::none> tree;
+    for (key_type key = 0; key < 100; ++key) { tree.insert(key, key); }
+    tree.find(5);
+    tree.balance();
+    const auto stats = tree.stats();
+    CHECK(stats.find.calls == 0 && stats.insert.calls == 0 && stats.balance_calls == 0);
+    CHECK(stats.live_nodes == 100);
+    CHECK(stats.height == tree.height());
+}
+
+int main()
+{
+    against_trace<balancing::none>();
+    against_trace<balancing::avl>();
+    against_trace<balancing::ranked_avl>();
+    descents();
+    json();
+    no_instrumentation();
+    return test::result();
+}
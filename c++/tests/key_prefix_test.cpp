@@ -0,0 +1,217 @@
+/*
+key prefix test
+string keys with inline prefixes against the same tree without them and against std::map on a workload trace;
+keys chosen to tie on the prefix: the empty key, shared stems of 6 to 9 bytes, embedded zeros and bytes above
+0x7f, which must order as unsigned chars; lookups with hints and bounds, heterogeneous lookups, the empty
+tree, a single node, duplicate keys and erasing the root
+*/
+
+#include "binary_tree.h"
+#include "test.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using prefixed_tree = Tree<std::string, std::size_t, std::less<std::string>, balancing::avl>;
+
+/*! the order of std::string, in a comparator that the key traits do not know */
+struct plain_less {
+    bool operator()(const std::string & lhs, const std::string & rhs) const { return lhs < rhs; }
+};
+using plain_tree = Tree<std::string, std::size_t, plain_less, balancing::avl>;
+
+static_assert(key_prefix<std::string, std::less<std::string>>::enabled, "std::string keys keep a prefix");
+static_assert(key_prefix<std::string, std::less<>>::enabled, "also with the transparent comparator");
+static_assert(!key_prefix<std::string, plain_less>::enabled, "other comparators compare the keys");
+
+/*! keys that tie on the prefix: stems of 6 to 9 bytes, some with zeros and high bytes, and suffixes */
+std::vector<std::string> tricky_keys()
+{
+    const std::string stems[] = {"", "abcdef", "abcdefg", "abcdefgh", "abcdefghi", std::string("abc\0ef", 6),
+                                 std::string("abc\0efg\0", 8), "\xff\xfe\x80", "\x7f\x80\xff\xff\xff\xff\xff"};
+    const std::string suffixes[] = {"", std::string(1, '\0'), "a", "z", "\x80", "zz", "0123456789", "\xff\xff"};
+    std::vector<std::string> keys;
+    for (const auto & stem : stems) {
+        for (const auto & suffix : suffixes) { keys.push_back(stem + suffix); }
+    }
+    return keys;
+}
+
+/*! the prefix in every node is the one of its key */
+bool prefixes_stored(const prefixed_tree & tree)
+{
+    for (auto it = tree.begin(); it != tree.end(); ++it) {
+        if (it.get_node()->prefix != key_prefix<std::string, std::less<std::string>>::of(it->first)) { return false; }
+    }
+    return true;
+}
+
+/*! of() is ordered as the keys: a smaller prefix means a smaller key, and a decisive tie means equal keys */
+void prefix_order()
+{
+    using traits = key_prefix<std::string, std::less<std::string>>;
+    const auto keys = tricky_keys();
+    bool ordered = true;
+    for (const auto & a : keys) {
+        for (const auto & b : keys) {
+            const auto pa = traits::of(a), pb = traits::of(b);
+            if (pa < pb && !(a < b)) { ordered = false; }
+            if (pa == pb && traits::decisive(pa) && a != b) { ordered = false; }
+            if ((traits::compare(a, b) < 0) != (a < b)) { ordered = false; }
+        }
+    }
+    CHECK(ordered);
+    CHECK(traits::decisive(traits::of("")));
+    CHECK(traits::decisive(traits::of("abcdefg")));
+    CHECK(!traits::decisive(traits::of("abcdefgh")));
+}
+
+void small_trees()
+{
+    prefixed_tree tree;
+    CHECK(tree.find("") == tree.end());
+    CHECK(tree.find(std::string()) == tree.end());
+    tree.erase("");
+    CHECK(test::valid(tree));
+
+    tree.insert("", 1);                             // the empty key is a key like the others
+    CHECK(tree.size() == 1);
+    CHECK(tree.find("")->second == 1);
+    CHECK(tree.find(std::string(1, '\0')) == tree.end());
+    CHECK(!tree.insert("", 2).second);
+    CHECK(tree.find("")->second == 2);
+    tree.insert(std::string(1, '\0'), 3);
+    CHECK(tree.size() == 2);
+    CHECK(tree.begin()->first.empty());
+    tree.erase("");
+    CHECK(tree.find(std::string(1, '\0'))->second == 3);
+    CHECK(test::valid(tree));
+    CHECK(prefixes_stored(tree));
+}
+
+/*! the prefixed tree, the tree comparing whole keys and std::map replay the same trace on the tricky keys,
+    then agree on lookups of every key, with hints and bounds */
+void against_map()
+{
+    const auto keys = tricky_keys();
+    prefixed_tree tree;
+    plain_tree plain;
+    std::map<std::string, std::size_t> reference;
+    const auto trace = test::trace(workload::distribution::uniform, keys.size(), 20000);
+    bool same = true;
+    for (std::size_t i = 0; i < trace.size(); ++i) {
+        const std::string & key = keys[trace[i].key];
+        switch (trace[i].kind) {
+            case workload::op::find: {
+                const auto expected = reference.find(key);
+                const auto found = tree.find(key);
+                const auto found_plain = plain.find(key);
+                if (expected == reference.end()) {
+                    same = same && found == tree.end() && found_plain == plain.end();
+                } else {
+                    same = same && found != tree.end() && found->second == expected->second
+                           && found_plain != plain.end() && found_plain->second == expected->second;
+                }
+                break;
+            }
+            case workload::op::insert:
+                tree.insert(key, i);
+                plain.insert(key, i);
+                reference[key] = i;
+                break;
+            case workload::op::erase:
+                tree.erase(key);
+                plain.erase(key);
+                reference.erase(key);
+                break;
+        }
+    }
+    CHECK(same);
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(test::same_pairs(plain, reference));
+    CHECK(test::valid(tree));
+    CHECK(prefixes_stored(tree));
+
+    bool lookups = true;
+    for (const auto & key : keys) {
+        const auto expected = reference.lower_bound(key);
+        const auto lower = tree.lower_bound(key);
+        lookups = lookups && (expected == reference.end() ? lower == tree.end() : lower->first == expected->first);
+        const auto upper = tree.upper_bound(key);
+        const auto expected_upper = reference.upper_bound(key);
+        lookups = lookups && (expected_upper == reference.end() ? upper == tree.end() : upper->first == expected_upper->first);
+        const bool present = reference.count(key) != 0;
+        lookups = lookups && (tree.find(tree.begin(), key) != tree.end()) == present
+                  && (tree.find(std::prev(tree.end()), key) != tree.end()) == present;
+    }
+    CHECK(lookups);
+}
+
+/*! hinted inserts descend from the hint: the prefixes of the new nodes must be stored as well */
+void hinted_inserts()
+{
+    const auto keys = tricky_keys();
+    prefixed_tree tree;
+    std::map<std::string, std::size_t> reference;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        tree.insert(tree.lower_bound(keys[i]), keys[i], i);
+        reference[keys[i]] = i;
+    }
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(test::valid(tree));
+    CHECK(prefixes_stored(tree));
+}
+
+/*! std::less<> finds string views and C strings, which get their prefix computed once per descent */
+void heterogeneous()
+{
+    Tree<std::string, std::size_t, std::less<>, balancing::avl> tree;
+    const auto keys = tricky_keys();
+    for (std::size_t i = 0; i < keys.size(); ++i) { tree.insert(keys[i], i); }
+    bool found = true;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        const auto it = tree.find(std::string_view(keys[i]));
+        found = found && it != tree.end() && it->first == keys[i];
+    }
+    CHECK(found);
+    CHECK(tree.find("abcdefgh")->first == "abcdefgh");
+    CHECK(tree.find("abcdefgh!") == tree.end());
+    CHECK(tree.find(std::string_view("abc\0ef", 6)) != tree.end());
+    CHECK(tree.find(std::string_view("abc\0e", 5)) == tree.end());
+}
+
+/*! erases the key at the root until the tree is empty, checking the tree after every erase */
+void erase_root()
+{
+    const auto keys = tricky_keys();
+    prefixed_tree tree;
+    std::map<std::string, std::size_t> reference;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        tree.insert(keys[i], i);
+        reference[keys[i]] = i;
+    }
+    bool consistent = true;
+    while (!tree.empty() && consistent) {
+        auto root = tree.begin().get_node();
+        while (root->parent) { root = root->parent; }
+        const std::string key = root->data.first;
+        tree.erase(key);
+        reference.erase(key);
+        consistent = test::valid(tree) && test::same_pairs(tree, reference) && prefixes_stored(tree);
+    }
+    CHECK(consistent);
+}
+
+int main()
+{
+    prefix_order();
+    small_trees();
+    against_map();
+    hinted_inserts();
+    heterogeneous();
+    erase_root();
+    return test::result();
+}
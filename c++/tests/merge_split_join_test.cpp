@@ -0,0 +1,184 @@
+/*
+merge, split and join test
+merge() of trees of every balancing policy against merging two std::map, with duplicate keys resolved by
+merging::overwrite, merging::keep and a custom callable; join() of disjoint key ranges on either side, and of
+overlapping ones; split() at keys below, inside and above the tree. The results are balanced, relink the same
+nodes, and leave the source empty; pool allocated trees recreate them. Covers empty trees, single nodes and
+a resolve that throws
+*/
+
+#include "binary_tree.h"
+#include "pool_allocator.h"
+#include "test.h"
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+using key_type = std::uint64_t;
+using reference_type = std::map<key_type, std::string>;
+
+/*! levels of a tree of minimum height holding count nodes */
+std::size_t minimum_height(std::size_t count)
+{
+    std::size_t levels = 0;
+    while (count >> levels) { ++levels; }
+    return levels;
+}
+
+/*! count pairs with keys drawn uniformly in [low, low + span) */
+reference_type pairs(key_type low, key_type span, std::size_t count, std::uint64_t seed, const std::string & tag)
+{
+    reference_type result;
+    workload::rng generator(seed);
+    for (std::size_t i = 0; i < count; ++i) { result[low + generator.below(span)] = tag + std::to_string(i); }
+    return result;
+}
+
+template <class TreeType>
+std::set<const void *> nodes_of(TreeType & tree)
+{
+    std::set<const void *> nodes;
+    for (auto it = tree.begin(); it != tree.end(); ++it) { nodes.insert(it.get_node()); }
+    return nodes;
+}
+
+/*! true if tree holds reference, is consistent and has minimum height */
+template <class TreeType>
+bool balanced_as(const TreeType & tree, const reference_type & reference)
+{
+    return test::same_pairs(tree, reference) && test::valid(tree) && tree.height() == minimum_height(tree.size());
+}
+
+/*! Relinked: the nodes are moved between the trees, not recreated as with pool_allocator */
+template <class TreeType, bool Relinked>
+void merges()
+{
+    for (auto sizes : {std::pair<std::size_t, std::size_t>{0, 0}, {0, 1}, {1, 0}, {1, 1}, {500, 0}, {0, 500}, {500, 800}, {2000, 30}}) {
+        const auto left = pairs(0, 1500, sizes.first, 1, "a"), right = pairs(0, 1500, sizes.second, 2, "b");
+        TreeType a(left.begin(), left.end()), b(right.begin(), right.end());
+        auto before = nodes_of(a);
+        before.merge(nodes_of(b));
+        a.merge(std::move(b));
+        reference_type expected = left;
+        for (const auto & pair : right) { expected[pair.first] = pair.second; }
+        CHECK(balanced_as(a, expected));
+        CHECK(b.empty() && test::valid(b));
+        const auto after = nodes_of(a);
+        bool reused = true;
+        for (const void * node : after) { reused = reused && before.count(node); }
+        CHECK(reused || !Relinked);
+
+        TreeType kept(left.begin(), left.end()), other(right.begin(), right.end());
+        kept.merge(std::move(other), merging::keep());
+        expected = right;
+        for (const auto & pair : left) { expected[pair.first] = pair.second; }
+        CHECK(balanced_as(kept, expected));
+
+        TreeType joined(left.begin(), left.end()), more(right.begin(), right.end());
+        joined.merge(std::move(more), [](std::string & here, std::string && there) { here += "+" + there; });
+        for (const auto & pair : right) {
+            if (left.count(pair.first)) { expected[pair.first] = left.at(pair.first) + "+" + pair.second; }
+        }
+        CHECK(balanced_as(joined, expected));
+    }
+
+    const auto reference = pairs(0, 100, 50, 3, "s");
+    TreeType copy(reference.begin(), reference.end());
+    copy.merge(std::move(copy));                    // merging a tree into itself changes nothing
+    CHECK(test::same_pairs(copy, reference));
+}
+
+/*! a resolve that throws leaves both trees empty and consistent */
+template <class TreeType>
+void throwing_resolve()
+{
+    const auto left = pairs(0, 100, 80, 4, "a"), right = pairs(0, 100, 80, 5, "b");
+    TreeType a(left.begin(), left.end()), b(right.begin(), right.end());
+    bool thrown = false;
+    try {
+        a.merge(std::move(b), [](std::string &, std::string &&) { throw std::runtime_error("resolve"); });
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    CHECK(a.empty() && b.empty() && test::valid(a) && test::valid(b));
+    a.insert(1, "one");
+    CHECK(a.size() == 1);
+}
+
+template <class TreeType>
+void joins()
+{
+    const auto low = pairs(0, 1000, 700, 6, "l"), high = pairs(1000, 1000, 300, 7, "h");
+    reference_type both = low;
+    both.insert(high.begin(), high.end());
+    for (bool high_first : {false, true}) {
+        TreeType a(high_first ? high.begin() : low.begin(), high_first ? high.end() : low.end());
+        TreeType b(high_first ? low.begin() : high.begin(), high_first ? low.end() : high.end());
+        a.join(std::move(b));
+        CHECK(balanced_as(a, both));
+        CHECK(b.empty());
+        CHECK(std::prev(a.end())->first == both.rbegin()->first);    // the highest node is tracked
+    }
+    TreeType empty, single{{5000, "x"}};
+    empty.join(std::move(single));
+    CHECK(balanced_as(empty, reference_type{{5000, "x"}}));
+    empty.join(TreeType());
+    CHECK(empty.size() == 1);
+
+    const auto overlapping = pairs(500, 1000, 300, 8, "o");
+    TreeType a(low.begin(), low.end()), b(overlapping.begin(), overlapping.end());
+    a.join(std::move(b));                           // falls back to merge
+    reference_type merged = low;
+    for (const auto & pair : overlapping) { merged[pair.first] = pair.second; }
+    CHECK(balanced_as(a, merged));
+}
+
+template <class TreeType, bool Relinked>
+void splits()
+{
+    const auto reference = pairs(100, 1000, 600, 9, "v");
+    for (key_type key : {key_type{0}, key_type{100}, reference.begin()->first, key_type{600}, reference.rbegin()->first, key_type{5000}}) {
+        TreeType tree(reference.begin(), reference.end());
+        const auto before = nodes_of(tree);
+        auto halves = tree.split(key);
+        CHECK(tree.empty());
+        const reference_type lower(reference.begin(), reference.lower_bound(key)), upper(reference.lower_bound(key), reference.end());
+        CHECK(balanced_as(halves.first, lower));
+        CHECK(balanced_as(halves.second, upper));
+        if (Relinked) {
+            auto after = nodes_of(halves.first);
+            after.merge(nodes_of(halves.second));
+            CHECK(after == before);
+        }
+        halves.first.join(std::move(halves.second));    // and back
+        CHECK(balanced_as(halves.first, reference));
+        halves.first.insert(key, "inserted");
+        CHECK(test::valid(halves.first));
+    }
+    TreeType empty;
+    auto halves = empty.split(1);
+    CHECK(halves.first.empty() && halves.second.empty());
+}
+
+template <class TreeType, bool Relinked = true>
+void all(const char * name)
+{
+    std::cout << name << std::endl;
+    merges<TreeType, Relinked>();
+    throwing_resolve<TreeType>();
+    joins<TreeType>();
+    splits<TreeType, Relinked>();
+}
+
+int main()
+{
+    all<Tree<key_type, std::string>>("none");
+    all<Tree<key_type, std::string, std::less<key_type>, balancing::avl>>("avl");
+    all<Tree<key_type, std::string, std::less<key_type>, balancing::ranked_avl>>("ranked_avl");
+    all<Tree<key_type, std::string, std::less<key_type>, balancing::avl, pool_allocator<std::pair<const key_type, std::string>>>, false>("pool");
+    return test::result();
+}
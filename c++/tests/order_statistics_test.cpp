@@ -0,0 +1,125 @@
+/*
+order statistics test
+lower_bound, upper_bound, equal_range, count, rank, select and count_range of trees of every balancing policy
+against std::map, after workload traces, for every key of the key space and past both ends; backward and
+reverse iteration, and the empty tree and a single node
+*/
+
+#include "binary_tree.h"
+#include "test.h"
+
+#include <cstdint>
+#include <iterator>
+#include <map>
+
+using key_type = std::uint64_t;
+
+template <class Balance>
+using tree_type = Tree<key_type, std::size_t, std::less<key_type>, Balance>;
+
+/*! key pointed by it, or key_space if it is the end of map */
+template <class Map, class Iterator>
+key_type key_or_end(const Map & map, Iterator it, key_type key_space)
+{
+    return it == map.end() ? key_space : it->first;
+}
+
+template <class Balance>
+void queries(const tree_type<Balance> & tree, const std::map<key_type, std::size_t> & reference, key_type key_space)
+{
+    bool bounds = true, counts = true, ranks = true, ranges = true;
+    for (key_type key = 0; key <= key_space + 1; ++key) {
+        bounds = bounds
+            && key_or_end(tree, tree.lower_bound(key), key_space) == key_or_end(reference, reference.lower_bound(key), key_space)
+            && key_or_end(tree, tree.upper_bound(key), key_space) == key_or_end(reference, reference.upper_bound(key), key_space)
+            && tree.equal_range(key).first == tree.lower_bound(key) && tree.equal_range(key).second == tree.upper_bound(key);
+        counts = counts && tree.count(key) == reference.count(key);
+        const auto expected_rank = static_cast<std::size_t>(std::distance(reference.begin(), reference.lower_bound(key)));
+        ranks = ranks && tree.rank(key) == expected_rank;
+        const key_type last = key + key_space / 10;
+        const auto expected_range = static_cast<std::size_t>(std::distance(reference.lower_bound(key), reference.lower_bound(last)));
+        ranges = ranges && tree.count_range(key, last) == expected_range && tree.count_range(last, key) == 0;
+    }
+    CHECK(bounds);
+    CHECK(counts);
+    CHECK(ranks);
+    CHECK(ranges);
+
+    bool selected = true;
+    std::size_t index = 0;
+    for (auto it = reference.begin(); it != reference.end(); ++it, ++index) {
+        auto found = tree.select(index);
+        selected = selected && found != tree.end() && found->first == it->first;
+    }
+    CHECK(selected);
+    CHECK(tree.select(reference.size()) == tree.end());
+}
+
+template <class Balance>
+void backwards(const tree_type<Balance> & tree, const std::map<key_type, std::size_t> & reference)
+{
+    bool reverse = std::distance(tree.rbegin(), tree.rend()) == static_cast<std::ptrdiff_t>(reference.size());
+    auto expected = reference.rbegin();
+    for (auto it = tree.rbegin(); it != tree.rend() && reverse; ++it, ++expected) {
+        reverse = it->first == expected->first && it->second == expected->second;
+    }
+    CHECK(reverse);
+
+    bool decrement = true;                          // -- from end() and from every node, and back with ++
+    auto it = tree.end();
+    for (auto pair = reference.rbegin(); pair != reference.rend(); ++pair) {
+        --it;
+        auto next = std::next(it);
+        decrement = decrement && it->first == pair->first && (pair == reference.rbegin() ? next == tree.end() : next->first == std::prev(pair)->first);
+    }
+    CHECK(decrement);
+    CHECK(it == tree.begin());
+}
+
+template <class Balance>
+void small_trees()
+{
+    tree_type<Balance> tree;
+    CHECK(tree.lower_bound(0) == tree.end());
+    CHECK(tree.upper_bound(0) == tree.end());
+    CHECK(tree.rank(5) == 0);
+    CHECK(tree.count_range(0, 10) == 0);
+    CHECK(tree.select(0) == tree.end());
+    CHECK(tree.rbegin() == tree.rend());
+
+    tree.insert(5, 1);
+    CHECK(tree.lower_bound(5) == tree.begin());
+    CHECK(tree.upper_bound(5) == tree.end());
+    CHECK(tree.lower_bound(6) == tree.end());
+    CHECK(tree.rank(5) == 0);
+    CHECK(tree.rank(6) == 1);
+    CHECK(tree.count_range(5, 6) == 1);
+    CHECK(tree.select(0)->first == 5);
+    CHECK(std::prev(tree.end()) == tree.begin());
+    CHECK(tree.rbegin()->first == 5);
+}
+
+template <class Balance>
+void all(const char * name)
+{
+    std::cout << name << std::endl;
+    small_trees<Balance>();
+    for (auto d : {workload::distribution::uniform, workload::distribution::zipf, workload::distribution::clustered}) {
+        const key_type key_space = 2000;
+        tree_type<Balance> tree;
+        std::map<key_type, std::size_t> reference;
+        CHECK(test::replay(tree, reference, test::trace(d, key_space, 5000)));
+        CHECK(test::valid(tree));
+        queries<Balance>(tree, reference, key_space);
+        backwards<Balance>(tree, reference);
+    }
+}
+
+int main()
+{
+    all<balancing::none>("none");
+    all<balancing::avl>("avl");
+    all<balancing::ranked>("ranked");
+    all<balancing::ranked_avl>("ranked_avl");
+    return test::result();
+}
@@ -0,0 +1,129 @@
+/*
+parallel build test
+insert(pool, first, last) and balance(pool) against std::map and their serial versions, above and below the
+size at which they go parallel, with pools of one and several threads: sorted and unsorted input, duplicate
+keys (the last value wins), pool allocated nodes, and the empty range; parallelStableSort and parallelFor
+*/
+
+#include "binary_tree.h"
+#include "pool_allocator.h"
+#include "test.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+using key_type = std::uint64_t;
+using pair_type = std::pair<key_type, std::string>;
+
+/*! levels of a tree of minimum height holding count nodes */
+std::size_t minimum_height(std::size_t count)
+{
+    std::size_t levels = 0;
+    while (count >> levels) { ++levels; }
+    return levels;
+}
+
+std::vector<pair_type> pairs(workload::distribution d, std::uint64_t key_space, std::size_t count)
+{
+    workload::key_generator keys(d, key_space, 9);
+    std::vector<pair_type> result;
+    for (std::size_t i = 0; i < count; ++i) { result.emplace_back(keys(), std::to_string(i)); }
+    return result;
+}
+
+template <class TreeType>
+void parallel_insert(thread_pool & pool, const std::vector<pair_type> & range)
+{
+    TreeType tree;
+    tree.insert(pool, range.begin(), range.end());
+    std::map<key_type, std::string> reference;
+    for (const auto & pair : range) { reference[pair.first] = pair.second; }
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(test::valid(tree));
+    CHECK(tree.height() == minimum_height(tree.size()));
+    if (!tree.empty()) { CHECK(std::prev(tree.end())->first == reference.rbegin()->first); }
+
+    std::vector<pair_type> again(range.begin(), range.begin() + static_cast<std::ptrdiff_t>(range.size() / 2));
+    for (auto & pair : again) {                     // into a filled tree: one by one, overwriting
+        pair.second += " again";
+        reference[pair.first] = pair.second;
+    }
+    tree.insert(pool, again.begin(), again.end());
+    CHECK(test::same_pairs(tree, reference));
+}
+
+/*! a tree unbalanced by its insertion order is balanced by relinking the same nodes */
+template <class TreeType>
+void parallel_balance(thread_pool & pool, std::size_t count)
+{
+    TreeType tree;
+    std::map<key_type, std::string> reference;
+    workload::rng generator(21);
+    for (std::size_t i = 0; i < count; ++i) {       // random keys, then a chain of ascending ones
+        const key_type key = i < count / 2 ? generator.below(count) : i + count;
+        tree.insert(tree.end(), key, std::to_string(i));
+        reference[key] = std::to_string(i);
+    }
+    std::set<const void *> before;
+    for (auto it = tree.begin(); it != tree.end(); ++it) { before.insert(it.get_node()); }
+    tree.find_near(reference.begin()->first);      // the finger points to a node that moves
+    tree.balance(pool);
+    std::set<const void *> after;
+    for (auto it = tree.begin(); it != tree.end(); ++it) { after.insert(it.get_node()); }
+    CHECK(after == before);
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(test::valid(tree));
+    CHECK(tree.height() == minimum_height(tree.size()));
+    CHECK(tree.find_near(reference.rbegin()->first)->second == reference.rbegin()->second);
+    tree.insert_near(0, "zero");
+    reference[0] = "zero";
+    CHECK(test::same_pairs(tree, reference));
+}
+
+void sort_and_for(thread_pool & pool)
+{
+    workload::rng generator(4);
+    std::vector<std::pair<key_type, std::size_t>> values;
+    for (std::size_t i = 0; i < 40000; ++i) { values.emplace_back(generator.below(1000), i); }
+    auto expected = values;
+    auto by_key = [](const auto & lhs, const auto & rhs) { return lhs.first < rhs.first; };
+    std::stable_sort(expected.begin(), expected.end(), by_key);
+    detail::parallelStableSort(pool, values.begin(), values.end(), by_key, 1000);
+    CHECK(values == expected);
+
+    std::vector<std::atomic<int>> calls(10000);
+    detail::parallelFor(pool, 0, calls.size(), [&calls](std::size_t i) { ++calls[i]; });
+    CHECK(std::all_of(calls.begin(), calls.end(), [](const std::atomic<int> & c) { return c == 1; }));
+}
+
+template <class TreeType>
+void all(thread_pool & pool)
+{
+    parallel_insert<TreeType>(pool, {});
+    parallel_insert<TreeType>(pool, {{1, "one"}});
+    for (auto d : {workload::distribution::uniform, workload::distribution::sorted, workload::distribution::zipf}) {
+        parallel_insert<TreeType>(pool, pairs(d, 1000000, 40000));
+        parallel_insert<TreeType>(pool, pairs(d, 5000, 40000));      // many duplicates
+        parallel_insert<TreeType>(pool, pairs(d, 1000000, 1000));
+    }
+    parallel_balance<TreeType>(pool, 40000);
+    parallel_balance<TreeType>(pool, 100);
+}
+
+int main()
+{
+    thread_pool single(1), several(4);
+    for (thread_pool * pool : {&single, &several}) {
+        all<Tree<key_type, std::string>>(*pool);
+        all<Tree<key_type, std::string, std::less<key_type>, balancing::ranked_avl>>(*pool);
+        all<Tree<key_type, std::string, std::less<key_type>, balancing::none, pool_allocator<std::pair<const key_type, std::string>>>>(*pool);
+        sort_and_for(*pool);
+    }
+    return test::result();
+}
@@ -0,0 +1,139 @@
+/*
+parallel scan test
+parallel_for_each, parallel_reduce, parallel_count_if and parallel_for_each_ordered against the same scans
+of std::map, on the whole tree and on ranges [first, last): bounds below, inside, between and above the keys,
+and empty ranges; trees above and below parallel_cutoff, the empty tree, a single node and a chain of a tree
+that never rebalances, with pools of one and several threads
+*/
+
+#include "binary_tree.h"
+#include "test.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+using key_type = std::uint64_t;
+using reference_type = std::map<key_type, std::size_t>;
+using pair_type = std::pair<const key_type, std::size_t>;
+
+/*! Tree::parallel_cutoff: below this number of nodes the scans run serially */
+constexpr std::size_t cutoff = std::size_t{1} << 14;
+
+/*! the pairs of reference with keys in [first, last), in order */
+std::vector<std::pair<key_type, std::size_t>> range(const reference_type & reference, key_type first, key_type last)
+{
+    std::vector<std::pair<key_type, std::size_t>> pairs;
+    if (first >= last) { return pairs; }
+    for (auto it = reference.lower_bound(first); it != reference.end() && it->first < last; ++it) { pairs.push_back(*it); }
+    return pairs;
+}
+
+/*! the four scans of tree on [first, last) give the pairs of expected: for_each visits each once, in any order,
+    reduce combines them in order of key, count_if counts them, ordered hands them to the sink in order */
+template <class TreeType>
+bool scans(thread_pool & pool, const TreeType & tree, key_type first, key_type last,
+           const std::vector<std::pair<key_type, std::size_t>> & expected, bool whole)
+{
+    std::mutex lock;
+    std::vector<std::pair<key_type, std::size_t>> visited;
+    auto visit = [&lock, &visited](const pair_type & pair) {
+        std::lock_guard<std::mutex> guard(lock);
+        visited.emplace_back(pair.first, pair.second);
+    };
+    if (whole) { tree.parallel_for_each(pool, visit); } else { tree.parallel_for_each(pool, first, last, visit); }
+    std::sort(visited.begin(), visited.end());
+    bool same = visited == expected;
+
+    using keys = std::vector<key_type>;                 // concatenation: associative, not commutative
+    auto append = [](keys lhs, keys rhs) {
+        lhs.insert(lhs.end(), rhs.begin(), rhs.end());
+        return lhs;
+    };
+    auto single = [](const pair_type & pair) { return keys{pair.first}; };
+    const keys reduced = whole ? tree.parallel_reduce(pool, keys(), append, single)
+                               : tree.parallel_reduce(pool, first, last, keys(), append, single);
+    keys expected_keys;
+    for (const auto & pair : expected) { expected_keys.push_back(pair.first); }
+    same = same && reduced == expected_keys;
+
+    auto odd = [](const pair_type & pair) { return pair.second % 2 == 1; };
+    const std::size_t count = whole ? tree.parallel_count_if(pool, odd) : tree.parallel_count_if(pool, first, last, odd);
+    same = same && count == static_cast<std::size_t>(std::count_if(expected.begin(), expected.end(),
+                                                                   [](const auto & pair) { return pair.second % 2 == 1; }));
+
+    std::vector<std::pair<key_type, std::size_t>> sunk;
+    auto twice = [](const pair_type & pair) { return 2 * pair.second; };
+    bool matched = true;                                // the result given with a pair is the one mapped from it
+    auto sink = [&sunk, &matched](const pair_type & pair, std::size_t result) {
+        matched = matched && result == 2 * pair.second;
+        sunk.emplace_back(pair.first, pair.second);
+    };
+    if (whole) { tree.parallel_for_each_ordered(pool, twice, sink); } else { tree.parallel_for_each_ordered(pool, first, last, twice, sink); }
+    return same && matched && sunk == expected;
+}
+
+/*! the scans of tree on the whole tree and on ranges whose bounds fall below, on, between and above its keys */
+template <class TreeType>
+void against_map(thread_pool & pool, const TreeType & tree, const reference_type & reference)
+{
+    CHECK(scans(pool, tree, 0, 0, range(reference, 0, ~key_type{0}), true));
+    std::vector<key_type> bounds = {0, 1, ~key_type{0}};
+    if (!reference.empty()) {
+        const key_type low = reference.begin()->first, high = reference.rbegin()->first;
+        for (key_type bound : {low, low + 1, high, high + 1, low + (high - low) / 3, low + (high - low) / 2 + 1}) {
+            bounds.push_back(bound);
+        }
+    }
+    bool same = true;
+    for (key_type first : bounds) {
+        for (key_type last : bounds) {
+            if (first <= last) { same = same && scans(pool, tree, first, last, range(reference, first, last), false); }
+        }
+    }
+    CHECK(same);
+}
+
+using tree_type = Tree<key_type, std::size_t, std::less<key_type>, balancing::avl>;
+
+void random_trees(thread_pool & pool)
+{
+    for (std::size_t size : {std::size_t{0}, std::size_t{1}, std::size_t{1000}, cutoff - 1, cutoff, 3 * cutoff}) {
+        tree_type tree;
+        reference_type reference;
+        workload::rng generator(size + 3);
+        while (reference.size() < size) {
+            const key_type key = 2 + generator.below(8 * size);     // leaves room below and between the keys
+            tree.insert(key, reference.size());
+            reference[key] = reference.size();
+        }
+        CHECK(test::same_pairs(tree, reference));
+        against_map(pool, tree, reference);
+    }
+}
+
+/*! the scans walk subtrees with successor links, with no recursion on their depth */
+void chain(thread_pool & pool)
+{
+    Tree<key_type, std::size_t, std::less<key_type>, balancing::none> tree;
+    reference_type reference;
+    for (key_type key = 0; key < 2 * cutoff; ++key) {
+        tree.insert(tree.end(), 3 * key + 2, key);
+        reference[3 * key + 2] = key;
+    }
+    against_map(pool, tree, reference);
+}
+
+int main()
+{
+    for (unsigned threads : {1u, 4u}) {
+        thread_pool pool(threads);
+        random_trees(pool);
+        chain(pool);
+    }
+    return test::result();
+}
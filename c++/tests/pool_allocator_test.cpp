@@ -0,0 +1,105 @@
+/*
+pool allocator test
+Tree with pool_allocator against std::map on workload traces, with string values so that nodes have
+destructors to run; clear() and reuse of the pool, copies getting their own pool, and two trees sharing
+one allocator, where clearing one must leave the other intact
+*/
+
+#include "binary_tree.h"
+#include "pool_allocator.h"
+#include "test.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+using key_type = std::uint64_t;
+using pair_type = std::pair<const key_type, std::string>;
+using pooled_tree = Tree<key_type, std::string, std::less<key_type>, balancing::avl, pool_allocator<pair_type>>;
+
+/*! value stored for key: long enough not to fit in the small string buffer */
+std::string value_of(key_type key) { return "value of key number " + std::to_string(key); }
+
+void against_map()
+{
+    Tree<key_type, std::size_t, std::less<key_type>, balancing::avl, pool_allocator<std::pair<const key_type, std::size_t>>> tree;
+    std::map<key_type, std::size_t> reference;
+    CHECK(test::replay(tree, reference, test::trace(workload::distribution::uniform, 5000, 50000)));
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(test::valid(tree));
+}
+
+void clear_and_reuse()
+{
+    pooled_tree tree;
+    CHECK(tree.empty());
+    tree.clear();                                   // clearing an empty tree with an unused pool
+    for (int round = 0; round < 3; ++round) {
+        std::map<key_type, std::string> reference;
+        for (key_type key = 0; key < 2000; key += 3) {
+            tree.insert(key, value_of(key));
+            reference[key] = value_of(key);
+        }
+        for (key_type key = 0; key < 2000; key += 6) {   // freed nodes go to the free list, and are reused
+            tree.erase(key);
+            reference.erase(key);
+        }
+        for (key_type key = 1; key < 2000; key += 6) {
+            tree.insert(key, value_of(key));
+            reference[key] = value_of(key);
+        }
+        CHECK(test::same_pairs(tree, reference));
+        CHECK(test::valid(tree));
+        tree.clear();
+        CHECK(tree.empty());
+        CHECK(tree.begin() == tree.end());
+    }
+}
+
+void copies()
+{
+    pooled_tree tree;
+    for (key_type key = 0; key < 1000; ++key) { tree.insert(key, value_of(key)); }
+    pooled_tree copy(tree);
+    tree.clear();                                   // the copy has its own pool
+    CHECK(copy.size() == 1000);
+    CHECK(copy.find(999)->second == value_of(999));
+    CHECK(test::valid(copy));
+
+    pooled_tree moved(std::move(copy));
+    CHECK(moved.size() == 1000);
+    CHECK(moved.find(500)->second == value_of(500));
+    CHECK(test::valid(moved));
+}
+
+/*! two trees built from one allocator share its pool: clear() on one must not release the nodes of the other */
+void shared_pool()
+{
+    pool_allocator<pair_type> pool;
+    pooled_tree first(std::less<key_type>(), pool), second(std::less<key_type>(), pool);
+    CHECK(!pool.sole_owner());
+    for (key_type key = 0; key < 1000; ++key) {
+        first.insert(key, value_of(key));
+        second.insert(key, value_of(key + 1));
+    }
+    first.clear();
+    CHECK(first.empty());
+    std::size_t intact = 0;
+    for (key_type key = 0; key < 1000; ++key) { intact += second.find(key)->second == value_of(key + 1); }
+    CHECK(intact == 1000);
+    CHECK(test::valid(second));
+    for (key_type key = 0; key < 1000; ++key) { first.insert(key, value_of(key)); }    // reuses the freed nodes
+    CHECK(second.find(0)->second == value_of(1));
+
+    CHECK(!pool.release());                         // shared: nothing is freed
+    CHECK(pool_allocator<pair_type>().release());   // sole owner
+}
+
+int main()
+{
+    against_map();
+    clear_and_reuse();
+    copies();
+    shared_pool();
+    return test::result();
+}
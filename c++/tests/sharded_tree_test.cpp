@@ -0,0 +1,120 @@
+/*
+sharded tree test
+ShardedTree against std::map on workload traces, with a single shard and with many; for_each visiting every
+pair in order of key across the shards; threads inserting and erasing disjoint keys at once, and readers
+alongside them; the empty map, a single pair and duplicate keys
+*/
+
+#include "sharded_tree.h"
+#include "test.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using key_type = std::uint64_t;
+
+/*! true if for_each visits the pairs of reference, in the same order */
+template <class Sharded, class Reference>
+bool visits_in_order(const Sharded & tree, const Reference & reference)
+{
+    auto expected = reference.begin();
+    bool same = true;
+    tree.for_each([&](const key_type & key, const auto & value) {
+        same = same && expected != reference.end() && expected->first == key && expected->second == value;
+        if (expected != reference.end()) { ++expected; }
+    });
+    return same && expected == reference.end();
+}
+
+template <std::size_t N>
+void against_map(workload::distribution d)
+{
+    ShardedTree<key_type, std::size_t, N> tree;
+    std::map<key_type, std::size_t> reference;
+    bool same = true;
+    const auto trace = test::trace(d, 5000, 30000);
+    for (std::size_t i = 0; i < trace.size(); ++i) {
+        const key_type key = trace[i].key;
+        switch (trace[i].kind) {
+            case workload::op::find: {
+                const auto found = tree.find(key);
+                const auto expected = reference.find(key);
+                same = same && found.has_value() == (expected != reference.end()) && (!found || *found == expected->second)
+                            && tree.contains(key) == found.has_value();
+                break;
+            }
+            case workload::op::insert:
+                tree.insert(key, i);
+                reference[key] = i;
+                break;
+            case workload::op::erase:
+                tree.erase(key);
+                reference.erase(key);
+                break;
+        }
+    }
+    CHECK(same);
+    CHECK(tree.size() == reference.size());
+    CHECK(visits_in_order(tree, reference));
+}
+
+void small_maps()
+{
+    ShardedTree<key_type, std::string, 8> tree;
+    CHECK(tree.empty());
+    CHECK(!tree.find(1));
+    CHECK(visits_in_order(tree, std::map<key_type, std::string>()));
+    tree.erase(1);
+    tree.insert(1, "one");
+    tree.insert(1, "uno");                          // duplicate key: overwritten
+    CHECK(tree.size() == 1);
+    CHECK(*tree.find(1) == "uno");
+    CHECK(visits_in_order(tree, std::map<key_type, std::string>{{1, "uno"}}));
+    tree.clear();
+    CHECK(tree.empty());
+}
+
+/*! every thread inserts its own keys, then erases half of them, while a reader looks up the keys of all */
+void threads()
+{
+    const std::size_t writers = 4;
+    const key_type per_thread = 5000;
+    ShardedTree<key_type, key_type, 16> tree;
+    std::vector<std::thread> pool;
+    for (std::size_t t = 0; t < writers; ++t) {
+        pool.emplace_back([&tree, t, per_thread] {
+            for (key_type i = 0; i < per_thread; ++i) { tree.insert(i * writers + t, i); }
+            for (key_type i = 0; i < per_thread; i += 2) { tree.erase(i * writers + t); }
+        });
+    }
+    std::size_t wrong = 0;
+    pool.emplace_back([&tree, &wrong, per_thread] {
+        for (key_type key = 0; key < per_thread * writers; ++key) {
+            const auto value = tree.find(key);
+            wrong += value && *value != key / writers;
+        }
+    });
+    for (auto & thread : pool) { thread.join(); }
+    CHECK(wrong == 0);
+
+    std::map<key_type, key_type> reference;
+    for (std::size_t t = 0; t < writers; ++t) {
+        for (key_type i = 1; i < per_thread; i += 2) { reference[i * writers + t] = i; }
+    }
+    CHECK(tree.size() == reference.size());
+    CHECK(visits_in_order(tree, reference));
+}
+
+int main()
+{
+    for (auto d : {workload::distribution::uniform, workload::distribution::zipf, workload::distribution::sorted}) {
+        against_map<1>(d);
+        against_map<64>(d);
+    }
+    small_maps();
+    threads();
+    return test::result();
+}
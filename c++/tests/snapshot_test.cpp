@@ -0,0 +1,225 @@
+/*
+snapshot test
+save() and load() round trips of trees with integer and string keys and values, against std::map, and the same
+snapshots read in place by MappedTree: find, bounds and iteration. Corrupted files are rejected: a bad checksum,
+magic or size, a truncated file, a missing one and snapshots of other types make load() and open() fail, and
+offsets or lengths pointing out of the records make the reads throw std::runtime_error. Covers the empty
+tree, a single pair and the empty string
+*/
+
+#include "binary_tree.h"
+#include "mapped_tree.h"
+#include "test.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using key_type = std::uint64_t;
+
+/*! path of a scratch file of this test */
+std::string scratch(const std::string & name)
+{
+    return (std::filesystem::temp_directory_path() / ("snapshot_test_" + name)).string();
+}
+
+std::vector<char> read_bytes(const std::string & path)
+{
+    std::vector<char> bytes;
+    detail::readFile(path, bytes);
+    return bytes;
+}
+
+void write_bytes(const std::string & path, const std::vector<char> & bytes)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+/*! stores the checksum of the payload of bytes in its header, so that only the bounds checks can reject it */
+void reseal(std::vector<char> & bytes)
+{
+    const std::size_t header = sizeof(detail::snapshot_header);
+    const std::uint64_t checksum = detail::fnv1a(detail::fnv1a_basis, bytes.data() + header, bytes.size() - header);
+    std::memcpy(bytes.data() + offsetof(detail::snapshot_header, checksum), &checksum, sizeof(checksum));
+}
+
+/*! true if reading every pair of the mapped snapshot at path throws std::runtime_error */
+template <class K, class T>
+bool reads_throw(const std::string & path)
+{
+    MappedTree<K, T> mapped;
+    if (!mapped.open(path)) { return false; }
+    try {
+        for (auto it = mapped.begin(); it != mapped.end(); ++it) { *it; }
+    } catch (const std::runtime_error &) {
+        return true;
+    }
+    return false;
+}
+
+template <class K, class T, class Reference>
+void round_trip(const Reference & reference, const std::string & name)
+{
+    const std::string path = scratch(name);
+    Tree<K, T, std::less<K>, balancing::avl> tree(reference.begin(), reference.end());
+    CHECK(tree.save(path));
+
+    Tree<K, T, std::less<K>, balancing::avl> loaded{{K(), T()}};
+    CHECK(loaded.load(path));
+    CHECK(test::same_pairs(loaded, reference));
+    CHECK(test::valid(loaded));
+
+    for (bool verify : {false, true}) {
+        MappedTree<K, T> mapped(path, verify);
+        CHECK(mapped.is_open());
+        CHECK(mapped.size() == reference.size());
+        bool same = true;
+        auto it = mapped.begin();
+        for (const auto & pair : reference) {
+            same = same && it != mapped.end() && K(it->first) == pair.first && T(it->second) == pair.second
+                        && mapped.find(pair.first) == it && mapped.lower_bound(pair.first) == it
+                        && mapped.upper_bound(pair.first) == std::next(it);
+            ++it;
+        }
+        CHECK(same && it == mapped.end());
+    }
+    std::remove(path.c_str());
+}
+
+void round_trips()
+{
+    std::map<key_type, key_type> numbers;
+    round_trip<key_type, key_type>(numbers, "empty");
+    numbers[7] = 49;
+    round_trip<key_type, key_type>(numbers, "single");
+    workload::key_generator keys(workload::distribution::uniform, 1000000, 3);
+    for (int i = 0; i < 10000; ++i) {
+        const key_type key = keys();
+        numbers[key] = key * 3;
+    }
+    round_trip<key_type, key_type>(numbers, "numbers");
+
+    std::map<std::string, std::string> strings{{"", "empty key"}, {"empty value", ""}};
+    for (int i = 0; i < 2000; ++i) { strings["key " + std::to_string(i * 7)] = std::string(static_cast<std::size_t>(i % 50), 'v'); }
+    round_trip<std::string, std::string>(strings, "strings");
+
+    Tree<key_type, key_type> tree{{1, 1}, {2, 4}};
+    MappedTree<key_type, key_type> mapped;
+    CHECK(tree.save(scratch("bounds")) && mapped.open(scratch("bounds")));
+    CHECK(mapped.find(3) == mapped.end() && mapped.find(0) == mapped.end());
+    CHECK(mapped.lower_bound(0) == mapped.begin() && mapped.upper_bound(2) == mapped.end());
+    MappedTree<key_type, key_type> moved(std::move(mapped));
+    CHECK(!mapped.is_open() && moved.size() == 2);
+    moved.close();
+    CHECK(!moved.is_open() && moved.empty());
+    std::remove(scratch("bounds").c_str());
+}
+
+/*! files that are not a valid snapshot of the expected types: load() fails and keeps the tree, open() fails */
+void rejected_files()
+{
+    const std::string path = scratch("valid"), bad = scratch("bad");
+    Tree<std::string, std::string> tree;
+    for (int i = 0; i < 100; ++i) { tree.insert("key " + std::to_string(i), "value " + std::to_string(i)); }
+    CHECK(tree.save(path));
+    const auto bytes = read_bytes(path);
+    const std::size_t header = sizeof(detail::snapshot_header);
+
+    auto rejects = [&bad](const std::vector<char> & corrupted) {
+        write_bytes(bad, corrupted);
+        Tree<std::string, std::string> kept{{"kept", "pair"}};
+        MappedTree<std::string, std::string> mapped;
+        return !kept.load(bad) && kept.size() == 1 && kept.find("kept") != kept.end() && !mapped.open(bad, true);
+    };
+    auto flipped = bytes;
+    flipped[header + 10] ^= 1;
+    CHECK(rejects(flipped));                        // checksum
+    auto magic = bytes;
+    magic[0] = 'X';
+    CHECK(rejects(magic));
+    auto count = bytes;
+    const std::uint64_t huge = ~std::uint64_t{0} / 2;
+    std::memcpy(count.data() + offsetof(detail::snapshot_header, count), &huge, sizeof(huge));
+    CHECK(rejects(count));
+    CHECK(rejects(std::vector<char>(bytes.begin(), bytes.end() - 1)));
+    CHECK(rejects(std::vector<char>(bytes.begin(), bytes.begin() + static_cast<std::ptrdiff_t>(header) - 1)));
+    CHECK(rejects(std::vector<char>()));
+
+    Tree<key_type, std::string> other_key;
+    Tree<std::string, key_type> other_value;
+    CHECK(!other_key.load(path) && !other_value.load(path));
+    MappedTree<key_type, std::string> mapped_key;
+    MappedTree<std::string, key_type> mapped_value;
+    CHECK(!mapped_key.open(path) && !mapped_value.open(path));
+    Tree<std::string, std::string> missing;
+    MappedTree<std::string, std::string> mapped_missing;
+    CHECK(!missing.load(scratch("missing")) && !mapped_missing.open(scratch("missing")));
+    std::remove(path.c_str());
+    std::remove(bad.c_str());
+}
+
+/*! offsets and lengths reaching out of the records, with a checksum matching them: reads throw */
+void corrupted_records()
+{
+    const std::string path = scratch("records"), bad = scratch("bad_records");
+    Tree<std::string, std::string> tree;
+    for (int i = 0; i < 100; ++i) { tree.insert("key " + std::to_string(i), "value " + std::to_string(i)); }
+    CHECK(tree.save(path));
+    const auto bytes = read_bytes(path);
+    const std::size_t header = sizeof(detail::snapshot_header);
+    const std::size_t offsets = bytes.size() - 100 * sizeof(std::uint64_t);
+
+    auto throws = [&bad](std::vector<char> corrupted) {
+        reseal(corrupted);
+        write_bytes(bad, corrupted);
+        bool load_throws = false;
+        Tree<std::string, std::string> loaded;
+        try {
+            loaded.load(bad);
+        } catch (const std::runtime_error &) {
+            load_throws = true;
+        }
+        return load_throws && reads_throw<std::string, std::string>(bad);
+    };
+    for (std::uint64_t offset : {std::uint64_t{1} << 40, std::uint64_t{offsets - header}, std::uint64_t{offsets - header - 2}}) {
+        auto corrupted = bytes;
+        std::memcpy(corrupted.data() + offsets + 50 * sizeof(std::uint64_t), &offset, sizeof(offset));
+        CHECK(throws(corrupted));                   // record out of bounds
+    }
+    for (std::uint32_t length : {std::uint32_t{0xffffffff}, static_cast<std::uint32_t>(offsets - header)}) {
+        auto key_length = bytes, value_length = bytes;
+        std::memcpy(key_length.data() + header, &length, sizeof(length));
+        CHECK(throws(key_length));                  // field out of bounds
+        std::uint32_t key_size;
+        std::memcpy(&key_size, bytes.data() + header, sizeof(key_size));
+        std::memcpy(value_length.data() + header + sizeof(key_size) + key_size, &length, sizeof(length));
+        CHECK(throws(value_length));
+    }
+
+    Tree<key_type, key_type> numbers{{1, 1}, {2, 2}};
+    CHECK(numbers.save(path));
+    auto wrong_size = read_bytes(path);
+    const std::uint32_t four = 4;                   // fixed size fields must have the size of the type
+    std::memcpy(wrong_size.data() + header, &four, sizeof(four));
+    reseal(wrong_size);
+    write_bytes(bad, wrong_size);
+    CHECK((reads_throw<key_type, key_type>(bad)));
+    std::remove(path.c_str());
+    std::remove(bad.c_str());
+}
+
+int main()
+{
+    round_trips();
+    rejected_files();
+    corrupted_records();
+    return test::result();
+}
@@ -0,0 +1,115 @@
+/*
+static tree test
+lookups of a constexpr StaticTree checked by static_assert, so by the compiler; tables of 1 to 33 pairs,
+filling their perfect tree or not, against std::map: find of every key and of the gaps around them, operator[]
+and iteration order, with std::less and std::greater; the transparent comparator with string views; duplicate
+keys rejected. The empty table does not compile
+*/
+
+#include "static_tree.h"
+#include "test.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string_view>
+
+constexpr auto messages = make_static_tree<int, std::string_view>(
+    {{404, "not found"}, {200, "ok"}, {500, "server error"}, {301, "moved"}, {100, "continue"}});
+
+static_assert(messages.size() == 5, "size");
+static_assert(messages[200] == "ok" && messages[404] == "not found" && messages[100] == "continue", "operator[]");
+static_assert(messages.find(500)->second == "server error", "find");
+static_assert(messages.find(201) == messages.end() && messages.find(0) == messages.end()
+              && messages.find(1000) == messages.end(), "missing keys");
+static_assert(messages.begin()->first == 100, "begin is the smallest key");
+
+/*! true if the keys of tree are strictly increasing, in a constant expression */
+template <class Table>
+constexpr bool ascending(const Table & table)
+{
+    std::size_t count = 0;
+    auto previous = table.begin();
+    for (auto it = table.begin(); it != table.end(); ++it, ++count) {
+        if (count > 0 && !(previous->first < it->first)) { return false; }
+        previous = it;
+    }
+    return count == table.size();
+}
+static_assert(ascending(messages), "iteration in key order");
+
+constexpr auto single = make_static_tree<int, int>({{7, 49}});
+static_assert(single[7] == 49 && single.find(6) == single.end() && single.find(8) == single.end(), "single pair");
+static_assert(++single.begin() == single.end(), "single pair iteration");
+
+/*! N pairs with keys 0, 3, 6... given in a scrambled order, against std::map: every key, the gaps between keys
+    and beyond both ends, and iteration */
+template <std::size_t N, class Compare>
+void against_map()
+{
+    std::pair<int, std::uint64_t> pairs[N];
+    std::map<int, std::uint64_t, Compare> reference;
+    for (std::size_t i = 0; i < N; ++i) {
+        const std::size_t scrambled = N % 7 ? (i * 7) % N : N - 1 - i;     // a permutation of [0, N)
+        pairs[i] = {static_cast<int>(scrambled) * 3, static_cast<std::uint64_t>(i)};
+    }
+    for (const auto & pair : pairs) { reference.insert(pair); }
+    const StaticTree<int, std::uint64_t, N, Compare> tree(pairs);
+
+    bool found = true;
+    for (int key = -2; key <= static_cast<int>(N) * 3 + 2; ++key) {
+        const auto expected = reference.find(key);
+        const auto it = tree.find(key);
+        if (expected == reference.end()) {
+            found = found && it == tree.end();
+        } else {
+            found = found && it != tree.end() && it->first == key && it->second == expected->second
+                    && tree[key] == expected->second;
+        }
+    }
+    CHECK(found);
+    CHECK(test::same_pairs(tree, reference));
+}
+
+template <std::size_t... Sizes>
+void sizes(std::index_sequence<Sizes...>)
+{
+    (against_map<Sizes + 1, std::less<int>>(), ...);
+    (against_map<Sizes + 1, std::greater<int>>(), ...);
+}
+
+void missing_and_duplicate_keys()
+{
+    bool thrown = false;
+    try { (void)messages[201]; } catch (const std::out_of_range &) { thrown = true; }
+    CHECK(thrown);
+
+    const std::pair<int, int> twice[] = {{1, 1}, {2, 2}, {3, 3}, {1, 4}};
+    thrown = false;
+    try { StaticTree<int, int, 4> tree(twice); (void)tree; } catch (const std::invalid_argument &) { thrown = true; }
+    CHECK(thrown);
+
+    const std::pair<int, int> adjacent[] = {{5, 1}, {5, 2}};
+    thrown = false;
+    try { (void)make_static_tree(adjacent); } catch (const std::invalid_argument &) { thrown = true; }
+    CHECK(thrown);
+}
+
+/*! std::less<> finds C strings and string views in a table of string views */
+void transparent()
+{
+    constexpr auto names = make_static_tree<std::string_view, int, std::less<>>({{"b", 2}, {"a", 1}, {"", 0}, {"ab", 3}});
+    static_assert(names.find("ab")->second == 3 && names.find("")->second == 0, "transparent find");
+    CHECK(names.find(std::string_view("a"))->second == 1);
+    CHECK(names.find("abc") == names.end());
+    CHECK(names.begin()->first.empty());
+}
+
+int main()
+{
+    sizes(std::make_index_sequence<33>());
+    missing_and_duplicate_keys();
+    transparent();
+    return test::result();
+}
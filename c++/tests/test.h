@@ -0,0 +1,160 @@
+/**
+* @file test.h
+*
+* @brief Checks shared by the tests: CHECK, comparison of a map with std::map on a workload trace,
+*        and validation of the links and bookkeeping of the nodes of a Tree
+*
+*
+*/
+#pragma once
+
+#include <cstddef>   // size_t
+#include <cstdint>   // uint64_t
+#include <cstdlib>   // EXIT_SUCCESS
+#include <iostream>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "workload.h"
+
+
+/*! counts a failure, printing condition and where it was checked, if condition is false. Tests go on after
+    a failure, so that one run reports all of them */
+#define CHECK(condition) test::check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
+
+
+/*! namespace for the helpers of the test programs */
+namespace test {
+
+    inline int & failures() noexcept {
+        static int count = 0;
+        return count;
+    }
+
+    inline bool check(bool passed, const char * condition, const char * file, int line) {
+        if (!passed) {
+            ++failures();
+            std::cerr << file << ":" << line << ": CHECK failed: " << condition << std::endl;
+        }
+        return passed;
+    }
+
+    /*! exit status of a test program: success if every check passed */
+    inline int result() {
+        if (failures() == 0) { return EXIT_SUCCESS; }
+        std::cerr << failures() << " checks failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    /*! requests on keys in [0, key_space) drawn from d, mixing finds, inserts and erases in the proportions m */
+    inline std::vector<workload::request> trace(workload::distribution d, std::uint64_t key_space, std::size_t count,
+                                                workload::mix m = {4, 4, 2}, std::uint64_t seed = 42) {
+        workload::key_generator keys(d, key_space, seed);
+        workload::rng generator(seed + 1);
+        return workload::make_trace(keys, m, count, generator);
+    }
+
+    /*! true if map holds the pairs of reference, in the same order */
+    template <class Map, class Reference>
+    bool same_pairs(const Map & map, const Reference & reference) {
+        if (map.size() != reference.size()) { return false; }
+        auto it = map.begin();
+        for (const auto & pair : reference) {
+            if (it == map.end() || !(it->first == pair.first) || !(it->second == pair.second)) { return false; }
+            ++it;
+        }
+        return it == map.end();
+    }
+
+    /*! value standing for the number i: i itself for arithmetic types, its decimal digits for strings */
+    template <class T>
+    T value_of(std::size_t i) {
+        if constexpr (std::is_arithmetic<T>::value) {
+            return static_cast<T>(i);
+        } else {
+            return T(std::to_string(i));
+        }
+    }
+
+    /*! replays trace on map and on reference, a std::map: inserts store the position of the request as value
+        (see value_of), overwriting, and every find must give the same result in both. Map needs insert(key, value) overwriting
+        the value of a present key, erase(key) and find(key). False at the first difference */
+    template <class Map, class Reference>
+    bool replay(Map & map, Reference & reference, const std::vector<workload::request> & trace) {
+        for (std::size_t i = 0; i < trace.size(); ++i) {
+            const auto key = trace[i].key;
+            switch (trace[i].kind) {
+                case workload::op::find: {
+                    auto it = map.find(key);
+                    const auto expected = reference.find(key);
+                    if ((it == map.end()) != (expected == reference.end())) { return false; }
+                    if (expected != reference.end() && !(it->second == expected->second)) { return false; }
+                    break;
+                }
+                case workload::op::insert: {
+                    const auto value = value_of<typename Reference::mapped_type>(i);
+                    map.insert(key, value);
+                    reference[key] = value;
+                    break;
+                }
+                case workload::op::erase:
+                    map.erase(key);
+                    reference.erase(key);
+                    break;
+            }
+        }
+        return true;
+    }
+
+    /*! true if the nodes keep the height of their subtree, as balancing::avl */
+    template <class NodeType, class = void>
+    struct has_height : std::false_type {};
+
+    template <class NodeType>
+    struct has_height<NodeType, std::void_t<decltype(std::declval<NodeType &>().height)>> : std::true_type {};
+
+    /*! true if the nodes keep the size of their subtree, as balancing::ranked */
+    template <class NodeType, class = void>
+    struct has_size : std::false_type {};
+
+    template <class NodeType>
+    struct has_size<NodeType, std::void_t<decltype(std::declval<NodeType &>().size)>> : std::true_type {};
+
+    /*! checks the subtree of node below parent, with keys in (lo, hi) when given, and returns its height and
+        size; height -1 if an invariant is broken. Recursive: meant for trees that are not degenerate */
+    template <class NodeType, class Compare>
+    std::pair<long, std::size_t> checkSubtree(const NodeType * node, const NodeType * parent, const NodeType * lo,
+                                              const NodeType * hi, const Compare & comp) {
+        if (!node) { return {0, 0}; }
+        if (node->parent != parent
+            || (lo && !comp(lo->data.first, node->data.first)) || (hi && !comp(node->data.first, hi->data.first))) {
+            return {-1, 0};
+        }
+        const auto left = checkSubtree(node->left, node, lo, node, comp);
+        const auto right = checkSubtree(node->right, node, node, hi, comp);
+        if (left.first < 0 || right.first < 0) { return {-1, 0}; }
+        const long height = 1 + std::max(left.first, right.first);
+        const std::size_t size = 1 + left.second + right.second;
+        if constexpr (has_height<NodeType>::value) {
+            if (node->height != height || left.first - right.first > 1 || right.first - left.first > 1) { return {-1, 0}; }
+        }
+        if constexpr (has_size<NodeType>::value) {
+            if (node->size != size) { return {-1, 0}; }
+        }
+        return {height, size};
+    }
+
+    /*! true if the nodes of tree are linked consistently: parent links, keys strictly increasing in order,
+        the bookkeeping of the balancing policy (AVL heights and balance, subtree sizes), size() and height() */
+    template <class TreeType>
+    bool valid(const TreeType & tree) {
+        auto node = tree.begin().get_node();
+        if (!node) { return tree.size() == 0 && tree.height() == 0; }
+        while (node->parent) { node = node->parent; }
+        const auto checked = checkSubtree<std::remove_const_t<std::remove_reference_t<decltype(*node)>>>(
+            node, nullptr, nullptr, nullptr, tree.key_comp());
+        return checked.first >= 0 && checked.second == tree.size() && static_cast<std::size_t>(checked.first) == tree.height();
+    }
+}
@@ -0,0 +1,198 @@
+/*
+upsert test
+operator[], try_emplace, insert_or_assign and emplace against std::map on a workload trace; the empty tree,
+a single node and duplicate keys; const operator[] throwing on a missing key; values that count their copies,
+which the upserts must move or build in place, and move only values; one descent per call, counted by
+instrument::counting
+*/
+
+#include "binary_tree.h"
+#include "test.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using key_type = std::uint64_t;
+using tree_type = Tree<key_type, std::size_t, std::less<key_type>, balancing::avl>;
+
+/*! a value counting how often values were copied */
+struct counted {
+    static std::size_t copies;
+    std::string text;
+
+    counted() = default;
+    explicit counted(std::string s) : text(std::move(s)) {}
+    counted(const counted & other) : text(other.text) { ++copies; }
+    counted(counted &&) = default;
+    counted & operator=(const counted & other) { text = other.text; ++copies; return *this; }
+    counted & operator=(counted &&) = default;
+};
+std::size_t counted::copies = 0;
+
+void empty_and_single()
+{
+    tree_type tree;
+    const tree_type & empty = tree;
+    bool thrown = false;
+    try { (void)empty[1]; } catch (const std::out_of_range &) { thrown = true; }
+    CHECK(thrown);
+    CHECK(tree.empty());                            // the const operator[] inserts nothing
+
+    CHECK(tree[5] == 0);                            // value initialized
+    CHECK(tree.size() == 1);
+    tree[5] += 3;
+    CHECK(empty[5] == 3);
+    CHECK(test::valid(tree));
+
+    thrown = false;
+    try { (void)empty[4]; } catch (const std::out_of_range &) { thrown = true; }
+    CHECK(thrown);
+}
+
+void duplicate_keys()
+{
+    tree_type tree;
+    auto first = tree.try_emplace(3, 1);
+    CHECK(first.second && first.first->second == 1);
+    auto again = tree.try_emplace(3, 2);            // present: left untouched
+    CHECK(!again.second && again.first == first.first && again.first->second == 1);
+
+    auto emplaced = tree.emplace(3, 4);
+    CHECK(!emplaced.second && emplaced.first->second == 1);
+    emplaced = tree.emplace(std::make_pair(key_type{4}, std::size_t{4}));
+    CHECK(emplaced.second && emplaced.first->first == 4);
+
+    auto assigned = tree.insert_or_assign(3, 5);    // present: assigned
+    CHECK(!assigned.second && assigned.first == first.first && assigned.first->second == 5);
+    assigned = tree.insert_or_assign(2, 6);
+    CHECK(assigned.second && assigned.first->second == 6);
+
+    CHECK(test::same_pairs(tree, std::map<key_type, std::size_t>{{2, 6}, {3, 5}, {4, 4}}));
+    CHECK(test::valid(tree));
+}
+
+/*! replays a trace with a different upsert for each insert, in turn, applying the same to std::map */
+void against_map()
+{
+    tree_type tree;
+    std::map<key_type, std::size_t> reference;
+    const auto trace = test::trace(workload::distribution::zipf, 2000, 30000);
+    bool same = true;
+    for (std::size_t i = 0; i < trace.size() && same; ++i) {
+        const key_type key = trace[i].key;
+        switch (trace[i].kind) {
+            case workload::op::find:
+                same = (tree.find(key) == tree.end()) == (reference.find(key) == reference.end());
+                break;
+            case workload::op::insert:
+                switch (i % 4) {
+                    case 0: {
+                        const auto got = tree.try_emplace(key, i);
+                        const auto expected = reference.try_emplace(key, i);
+                        same = got.second == expected.second && got.first->second == expected.first->second;
+                        break;
+                    }
+                    case 1: {
+                        const auto got = tree.insert_or_assign(key, i);
+                        const auto expected = reference.insert_or_assign(key, i);
+                        same = got.second == expected.second && got.first->second == expected.first->second;
+                        break;
+                    }
+                    case 2: {
+                        const auto got = tree.emplace(key, i);
+                        const auto expected = reference.emplace(key, i);
+                        same = got.second == expected.second && got.first->second == expected.first->second;
+                        break;
+                    }
+                    default:
+                        tree[key] += i;
+                        reference[key] += i;
+                        same = tree.find(key)->second == reference[key];
+                }
+                break;
+            case workload::op::erase:
+                tree.erase(key);
+                reference.erase(key);
+                break;
+        }
+    }
+    CHECK(same);
+    CHECK(test::same_pairs(tree, reference));
+    CHECK(test::valid(tree));
+}
+
+/*! rvalues are moved into the tree, try_emplace builds the value in place, and try_emplace on a present key
+    leaves its arguments alone */
+void no_copies()
+{
+    Tree<key_type, counted, std::less<key_type>, balancing::avl> tree;
+    counted::copies = 0;
+    tree.insert_or_assign(1, counted("one"));
+    tree.insert_or_assign(1, counted("uno"));
+    tree.try_emplace(2, "two");
+    tree.emplace(3, counted("three"));
+    tree[4].text = "four";
+    tree.insert(5, counted("five"));
+    counted six("six");
+    tree.insert_or_assign(6, std::move(six));
+    CHECK(counted::copies == 0);
+
+    counted kept("kept");
+    CHECK(!tree.try_emplace(2, std::move(kept)).second);
+    CHECK(kept.text == "kept");                     // not moved from
+
+    CHECK(tree.find(1)->second.text == "uno");
+    CHECK(tree.find(2)->second.text == "two");
+    CHECK(tree[4].text == "four");
+    CHECK(tree.size() == 6);
+    CHECK(counted::copies == 0);
+}
+
+void move_only()
+{
+    Tree<key_type, std::unique_ptr<int>, std::less<key_type>, balancing::avl> tree;
+    CHECK(tree.try_emplace(1, std::make_unique<int>(1)).second);
+    CHECK(tree.insert_or_assign(2, std::make_unique<int>(2)).second);
+    CHECK(!tree.insert_or_assign(2, std::make_unique<int>(20)).second);
+    CHECK(tree.emplace(3, std::make_unique<int>(3)).second);
+    tree[4] = std::make_unique<int>(4);
+    CHECK(*tree[1] == 1 && *tree[2] == 20 && *tree[3] == 3 && *tree[4] == 4);
+    CHECK(!tree[5]);
+    tree.erase(3);
+    CHECK(tree.size() == 4);
+    CHECK(test::valid(tree));
+}
+
+/*! every upsert costs one descent, counted as an insert, and no find */
+void single_descent()
+{
+    Tree<key_type, std::size_t, std::less<key_type>, balancing::avl, std::allocator<std::pair<const key_type, std::size_t>>,
+         instrument::counting> tree;
+    for (key_type key = 0; key < 1000; ++key) { tree.insert(key, key); }
+    tree.reset_stats();
+    for (key_type key = 500; key < 1500; ++key) {
+        tree[key] += 1;
+        tree.try_emplace(key, 0);
+        tree.insert_or_assign(key, key);
+        tree.emplace(key, 0);
+    }
+    const auto stats = tree.stats();
+    CHECK(stats.insert.calls == 4000);
+    CHECK(stats.find.calls == 0);
+    CHECK(tree.size() == 1500);
+    CHECK(test::valid(tree));
+}
+
+int main()
+{
+    empty_and_single();
+    duplicate_keys();
+    against_map();
+    no_copies();
+    move_only();
+    single_descent();
+    return test::result();
+}
@@ -0,0 +1,193 @@
+/*
+workload test
+key_generator: keys within the key space for every distribution, determinism of the seed, the exact sequences
+of sorted, reverse_sorted and clustered, the skew of zipf and hot_set, and the rejection of zipf skews outside
+(0, 1); traces in the proportions of their mix, and the round trip of the binary trace format with the rejection
+of corrupted traces; rng, multiplyHigh and the names of the distributions
+*/
+
+#include "test.h"
+#include "workload.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+const workload::distribution distributions[] = {
+    workload::distribution::uniform, workload::distribution::zipf, workload::distribution::sorted,
+    workload::distribution::reverse_sorted, workload::distribution::clustered, workload::distribution::hot_set};
+
+std::vector<std::uint64_t> draw(workload::key_generator & keys, std::size_t count)
+{
+    std::vector<std::uint64_t> result(count);
+    for (auto & key : result) { key = keys(); }
+    return result;
+}
+
+void keys_in_space()
+{
+    for (auto d : distributions) {
+        for (std::uint64_t space : {std::uint64_t{0}, std::uint64_t{1}, std::uint64_t{2}, std::uint64_t{1000}, std::uint64_t{1} << 40}) {
+            workload::key_generator keys(d, space, 1);
+            bool within = true;
+            for (const auto key : draw(keys, 10000)) { within = within && key < (space ? space : 1); }
+            CHECK(within);
+        }
+        workload::key_generator first(d, 100000, 7), second(d, 100000, 7), other(d, 100000, 8);
+        const auto sequence = draw(first, 1000);
+        CHECK(sequence == draw(second, 1000));
+        if (d != workload::distribution::sorted && d != workload::distribution::reverse_sorted) {
+            CHECK(sequence != draw(other, 1000));
+        }
+        workload::distribution parsed;
+        CHECK(workload::parse(workload::name(d), parsed) && parsed == d);
+    }
+    workload::distribution parsed = workload::distribution::zipf;
+    CHECK(!workload::parse("gaussian", parsed) && parsed == workload::distribution::zipf);
+}
+
+void sequences()
+{
+    workload::key_generator sorted(workload::distribution::sorted, 5, 1);
+    CHECK(draw(sorted, 7) == (std::vector<std::uint64_t>{0, 1, 2, 3, 4, 0, 1}));
+    workload::key_generator reverse(workload::distribution::reverse_sorted, 5, 1);
+    CHECK(draw(reverse, 7) == (std::vector<std::uint64_t>{4, 3, 2, 1, 0, 4, 3}));
+
+    workload::shape runs;
+    runs.cluster = 8;
+    workload::key_generator clustered(workload::distribution::clustered, 1000000, 3, runs);
+    bool consecutive = true;
+    const auto keys = draw(clustered, 800);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        if (i % 8) { consecutive = consecutive && keys[i] == (keys[i - 1] + 1) % 1000000; }
+    }
+    CHECK(consecutive);
+}
+
+void skews()
+{
+    workload::key_generator zipf(workload::distribution::zipf, 1000000, 5);
+    std::vector<std::size_t> hits(100);
+    for (const auto key : draw(zipf, 200000)) {
+        if (key < hits.size()) { ++hits[key]; }
+    }
+    CHECK(hits[0] > hits[1] && hits[1] > hits[4] && hits[4] > hits[50]);
+    CHECK(hits[0] > 200000 / 100);                  // far above the share of a key drawn uniformly
+
+    workload::shape hot;
+    hot.hot_keys = 10;
+    hot.hot_fraction = 0.9;
+    workload::key_generator hot_set(workload::distribution::hot_set, 1000000, 5, hot);
+    std::map<std::uint64_t, std::size_t> counts;
+    for (const auto key : draw(hot_set, 100000)) { ++counts[key]; }
+    std::size_t in_hot_set = 0;
+    for (const auto & pair : counts) { in_hot_set += pair.second > 1000 ? pair.second : 0; }
+    CHECK(in_hot_set > 85000 && in_hot_set < 95000);
+}
+
+/*! zipf only accepts skews in (0, 1); the other distributions ignore the skew */
+void zipf_validation()
+{
+    for (double skew : {0.0, 1.0, 1.5, -0.5, std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity()}) {
+        workload::shape tuning;
+        tuning.skew = skew;
+        bool thrown = false;
+        try {
+            workload::key_generator keys(workload::distribution::zipf, 1000, 1, tuning);
+        } catch (const std::invalid_argument &) {
+            thrown = true;
+        }
+        CHECK(thrown);
+        workload::key_generator uniform(workload::distribution::uniform, 1000, 1, tuning);
+        CHECK(uniform() < 1000);
+    }
+    for (double skew : {0.01, 0.5, 0.99}) {
+        workload::shape tuning;
+        tuning.skew = skew;
+        workload::key_generator keys(workload::distribution::zipf, 1000, 1, tuning);
+        bool within = true;
+        for (const auto key : draw(keys, 1000)) { within = within && key < 1000; }
+        CHECK(within);
+    }
+}
+
+void traces()
+{
+    workload::key_generator keys(workload::distribution::uniform, 1000, 1);
+    workload::rng generator(2);
+    const auto trace = workload::make_trace(keys, {90, 9, 1}, 100000, generator);
+    std::size_t counts[3] = {0, 0, 0};
+    for (const auto & item : trace) { ++counts[static_cast<int>(item.kind)]; }
+    CHECK(counts[0] > 89000 && counts[0] < 91000);
+    CHECK(counts[1] > 8500 && counts[1] < 9500);
+    CHECK(counts[2] > 800 && counts[2] < 1200);
+    for (workload::mix only : {workload::mix{0, 0, 1}, workload::mix{0, 1, 0}}) {
+        bool single = true;
+        for (const auto & item : workload::make_trace(keys, only, 1000, generator)) {
+            single = single && item.kind == (only.erases ? workload::op::erase : workload::op::insert);
+        }
+        CHECK(single);
+    }
+
+    for (const auto & written : {trace, std::vector<workload::request>()}) {
+        std::stringstream stream;
+        CHECK(workload::write_trace(stream, written));
+        std::vector<workload::request> read{{workload::op::find, 1}};
+        CHECK(workload::read_trace(stream, read));
+        bool same = read.size() == written.size();
+        for (std::size_t i = 0; same && i < read.size(); ++i) { same = read[i].kind == written[i].kind && read[i].key == written[i].key; }
+        CHECK(same);
+    }
+
+    std::stringstream stream;
+    workload::write_trace(stream, std::vector<workload::request>{{workload::op::insert, ~std::uint64_t{0}}, {workload::op::erase, 5}});
+    const std::string bytes = stream.str();
+    CHECK(bytes.size() == 16 + 2 * 9);
+    auto rejected = [](const std::string & corrupted) {
+        std::istringstream in(corrupted);
+        std::vector<workload::request> read{{workload::op::find, 1}};
+        return !workload::read_trace(in, read) && read.empty();
+    };
+    std::string bad_magic = bytes, bad_op = bytes;
+    bad_magic[0] = 'X';
+    bad_op[16 + 9] = 3;
+    CHECK(rejected(bad_magic));
+    CHECK(rejected(bad_op));
+    CHECK(rejected(bytes.substr(0, bytes.size() - 1)));
+    CHECK(rejected(bytes.substr(0, 10)));
+    CHECK(rejected(""));
+}
+
+void numbers()
+{
+    workload::rng generator(9);
+    bool within = true;
+    for (int i = 0; i < 100000; ++i) {
+        const double u = generator.unit();
+        within = within && generator.below(7) < 7 && u >= 0 && u < 1;
+    }
+    CHECK(within);
+    CHECK(generator.below(1) == 0);
+
+    const std::uint64_t ones = ~std::uint64_t{0};
+    CHECK(workload::multiplyHigh(std::uint64_t{1} << 63, 4) == 2);
+    CHECK(workload::multiplyHigh(ones, ones) == ones - 1);
+    CHECK(workload::multiplyHigh(ones, 1) == 0);
+    CHECK(workload::multiplyHigh(0x123456789abcdef0, 0xfedcba9876543210) == 0x121fa00ad77d7422);
+}
+
+int main()
+{
+    keys_in_space();
+    sequences();
+    skews();
+    zipf_validation();
+    traces();
+    numbers();
+    return test::result();
+}
@@ -1,27 +1,40 @@
-#include <iostream>
-#include <random>
-#include <set>
+/*
+prints keys drawn from one of the distributions of workload.h, and how many distinct keys they are
 
-using namespace std;
+gets up to 4 arguments:
+1) distribution: uniform (default), zipf, sorted, reverse_sorted, clustered, hot_set
+2) number of keys to draw, 1000000 by default
+3) key space: keys are in [0, key_space), 10^18 by default
+4) seed, 42 by default
 
-long long int llRand()   // random number between 0 and 10^18
-{
-    std::random_device rd;  //Will be used to obtain a seed for the random number engine
-    std::mt19937 gen(rd()); //Standard mersenne_twister_engine seeded with rd()
-    std::uniform_int_distribution<long long int> dis(1, 1000000000000000000);   // 10^18
-    
-    return dis(gen);
-}
+example: ./random zipf 1000000 1000000 7
 
-int main()
-{
-	std::set<long long int>Totale;
+*/
 
-	for (int i=0; i <1000000;i++ ){
-		Totale.insert(llRand());
-	}
+#include "workload.h"
 
+#include <cstdlib>
+#include <iostream>
+#include <unordered_set>
+
+int main(int argc, char* argv[])
+{
+    workload::distribution kind = workload::distribution::uniform;
+    if (argc > 1 && !workload::parse(argv[1], kind)) {
+        std::cout << "unknown distribution " << argv[1] << std::endl;
+        return 1;
+    }
+    const auto count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000ULL;
+    const auto key_space = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1000000000000000000ULL;
+    const auto seed = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 42ULL;
 
-	cout << Totale.size();
-	return 0;
-}
\ No newline at end of file
+    workload::key_generator keys(kind, key_space, seed);
+    std::unordered_set<unsigned long long> distinct;
+    for (unsigned long long i = 0; i < count; ++i) {
+        const auto key = keys();
+        if (i < 10) { std::cout << key << "\n"; }
+        distinct.insert(key);
+    }
+    std::cout << "... " << distinct.size() << " distinct keys of " << count << " " << workload::name(kind) << std::endl;
+    return 0;
+}